@@ -1,12 +1,15 @@
 
+#include <zephyr/logger/logger.hpp>
 #include <zephyr/renderer/backend/render_backend_ogl.hpp>
 #include <zephyr/renderer/component/camera.hpp>
+#include <zephyr/renderer/component/prefab_instance.hpp>
 
 #include "gltf_loader.hpp"
 #include "main_window.hpp"
 
 static const bool enable_validation_layers = true;
 static const bool benchmark_scene_size = false;
+static const bool record_scene_journal = false; // Record the scene patches to scene.journal, for replaying them with zephyr-replay
 
 namespace zephyr {
 
@@ -40,6 +43,10 @@ void MainWindow::Setup() {
   #endif
 
   m_render_engine->SetSceneGraph(m_scene_graph);
+
+  if(record_scene_journal) {
+    m_scene_journal_recorder = std::make_unique<SceneJournalRecorder>("scene.journal");
+  }
 }
 
 void MainWindow::MainLoop() {
@@ -73,6 +80,10 @@ void MainWindow::MainLoop() {
             }
             break;
           }
+          case SDLK_p: {
+            PickNodesInFrontOfCamera();
+            break;
+          }
         }
       }
     }
@@ -109,7 +120,11 @@ void MainWindow::MainLoop() {
 }
 
 void MainWindow::RenderFrame() {
-  m_scene_graph->UpdateTransforms();
+  m_scene_graph->UpdateTransforms(m_thread_pool);
+  if(m_scene_journal_recorder) {
+    m_scene_journal_recorder->RecordFrame(*m_scene_graph);
+  }
+  m_scene_bvh.ApplyScenePatches(*m_scene_graph);
   m_render_engine->SubmitFrame();
   m_scene_graph->ClearScenePatches();
 
@@ -118,6 +133,19 @@ void MainWindow::RenderFrame() {
   UpdateFramesPerSecondCounter();
 }
 
+void MainWindow::PickNodesInFrontOfCamera() {
+  const Matrix4& camera_world = m_camera_node->GetTransform().GetWorld();
+
+  std::vector<SceneNodeHandle> picked_nodes{};
+  m_scene_bvh.QueryRay(camera_world.W().XYZ(), -camera_world.Z().XYZ(), 100.0f, picked_nodes);
+
+  for(const SceneNodeHandle picked_node : picked_nodes) {
+    if(const SceneNode* node = m_scene_graph->GetNode(picked_node); node) {
+      ZEPHYR_INFO("Picked node: {}", node->GetName());
+    }
+  }
+}
+
 void MainWindow::UpdateFramesPerSecondCounter() {
   const auto time_point_now = std::chrono::steady_clock::now();
 
@@ -149,10 +177,15 @@ void MainWindow::CreateScene() {
   m_behemoth_scene->GetTransform().SetScale({0.5f, 0.5f, 0.5f});
   m_scene_graph->GetRoot()->Add(m_behemoth_scene);
 
-  std::shared_ptr<SceneNode> gltf_scene_1 = gltf_loader.Parse("models/DamagedHelmet/DamagedHelmet.gltf");
-  gltf_scene_1->GetTransform().SetPosition({1.0f, 0.0f, -5.0f});
-  gltf_scene_1->GetTransform().SetRotation(extrinsic_xyz_angles_to_quaternion({1.5f, 0.0f, 0.0f}));
-  m_scene_graph->GetRoot()->Add(std::move(gltf_scene_1));
+  // Parse the helmet once and place it multiple times, sharing its geometry and materials between all placements.
+  const std::shared_ptr<const Prefab> helmet_prefab = Prefab::FromSubtree(gltf_loader.Parse("models/DamagedHelmet/DamagedHelmet.gltf").get());
+
+  for(int i = 0; i < 3; i++) {
+    std::shared_ptr<SceneNode> helmet_node = m_scene_graph->GetRoot()->CreateChild("DamagedHelmet");
+    helmet_node->CreateComponent<PrefabInstanceComponent>(helmet_prefab);
+    helmet_node->GetTransform().SetPosition({1.0f + (f32)i * 2.5f, 0.0f, -5.0f - (f32)i * 2.5f});
+    helmet_node->GetTransform().SetRotation(extrinsic_xyz_angles_to_quaternion({1.5f, 0.0f, 0.0f}));
+  }
 
   m_scene_graph->GetRoot()->Add(gltf_loader.Parse("models/triangleWithoutIndices/TriangleWithoutIndices.gltf"));
   //m_scene_graph->GetRoot()->Add(gltf_loader.Parse("models/triangle/Triangle.gltf"));
@@ -234,6 +267,9 @@ void MainWindow::CreateBenchmarkScene() {
 
   const int grid_size = 37;
 
+  // Mount all cubes in a single batch, so that the scene graph processes them in one go.
+  SceneGraphBatch scene_graph_batch{*m_scene_graph};
+
   for(int x = -grid_size / 2; x < grid_size / 2; x++) {
     for(int y = -grid_size / 2; y < grid_size / 2; y++) {
       for(int z = -grid_size / 2; z < grid_size / 2; z++) {
@@ -244,6 +280,8 @@ void MainWindow::CreateBenchmarkScene() {
 
         if(m_dynamic_cubes.size() < 32768) {
           m_dynamic_cubes.push_back(cube.get());
+        } else {
+          cube->SetStatic(true);
         }
       }
     }
@@ -3,11 +3,14 @@
 #include <zephyr/logger/sink/console.hpp>
 #include <zephyr/logger/logger.hpp>
 #include <zephyr/renderer/render_engine.hpp>
+#include <zephyr/renderer/scene_bvh.hpp>
+#include <zephyr/renderer/scene_journal.hpp>
 #include <zephyr/scene/scene_graph.hpp>
 #include <zephyr/scene/scene_node.hpp>
 #include <zephyr/float.hpp>
 #include <zephyr/integer.hpp>
 #include <zephyr/panic.hpp>
+#include <zephyr/thread_pool.hpp>
 #include <SDL.h>
 #include <vector>
 #include <optional>
@@ -27,6 +30,7 @@ class MainWindow {
     void MainLoop();
     void RenderFrame();
     void UpdateFramesPerSecondCounter();
+    void PickNodesInFrontOfCamera();
     void CreateScene();
     void CreateBenchmarkScene();
 
@@ -34,7 +38,10 @@ class MainWindow {
     void CleanupOpenGL();
 
     std::unique_ptr<RenderEngine> m_render_engine{};
+    ThreadPool m_thread_pool{};
     std::shared_ptr<SceneGraph> m_scene_graph{};
+    SceneBVH m_scene_bvh{};
+    std::unique_ptr<SceneJournalRecorder> m_scene_journal_recorder{};
     std::shared_ptr<SceneNode> m_camera_node{};
     std::shared_ptr<SceneNode> m_behemoth_scene{};
     std::vector<SceneNode*> m_dynamic_cubes{};
@@ -0,0 +1,187 @@
+
+#include <zephyr/logger/sink/console.hpp>
+#include <zephyr/logger/logger.hpp>
+#include <zephyr/renderer/render_scene.hpp>
+#include <zephyr/renderer/scene_journal.hpp>
+#include <zephyr/float.hpp>
+#include <zephyr/integer.hpp>
+#include <zephyr/panic.hpp>
+#include <zephyr/thread_pool.hpp>
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#ifdef ZEPHYR_OPENGL
+  #include <zephyr/renderer/backend/render_backend_ogl.hpp>
+#endif
+
+#include "null_render_backend.hpp"
+
+#undef main
+
+using namespace zephyr;
+
+/**
+ * Replays a scene journal recorded by SceneJournalRecorder into a RenderScene as fast as possible and reports the time spent in each stage.
+ * Usage: zephyr-replay <journal> [--backend=null|opengl] [--threads=<n>]
+ * The null backend renders nothing, so that the CPU side of the renderer can be measured without any influence of the GPU driver.
+ * With more than one thread, transforms and stage 2 are updated in parallel, sharing one thread pool since all stages run on the main thread.
+ */
+
+enum Stage {
+  STAGE_REPLAY,
+  STAGE_UPDATE_TRANSFORMS,
+  STAGE_UPDATE_STAGE_1,
+  STAGE_UPDATE_STAGE_2,
+  STAGE_RENDER,
+  STAGE_COUNT
+};
+
+static constexpr std::array<const char*, STAGE_COUNT> k_stage_names{
+  "Replay journal",
+  "SceneGraph::UpdateTransforms",
+  "RenderScene::UpdateStage1",
+  "RenderScene::UpdateStage2",
+  "RenderBackend::Render"
+};
+
+static void PrintTimings(std::array<std::vector<f64>, STAGE_COUNT>& timings) {
+  fmt::print("{:<32} {:>10} {:>10} {:>10} {:>10}\n", "stage (ms)", "avg", "min", "p99", "max");
+
+  for(int stage = 0; stage < STAGE_COUNT; stage++) {
+    std::vector<f64>& samples = timings[stage];
+
+    if(samples.empty()) {
+      continue;
+    }
+
+    f64 sum = 0.0;
+    for(const f64 sample : samples) {
+      sum += sample;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const f64 p99 = samples[std::min(samples.size() - 1u, samples.size() * 99u / 100u)];
+
+    fmt::print("{:<32} {:>10.4f} {:>10.4f} {:>10.4f} {:>10.4f}\n", k_stage_names[stage], sum / (f64)samples.size(), samples.front(), p99, samples.back());
+  }
+}
+
+int main(int argc, char** argv) {
+  get_logger().InstallSink(std::make_unique<LoggerConsoleSink>());
+
+  if(argc < 2) {
+    fmt::print("usage: {} <journal> [--backend=null|opengl] [--threads=<n>]\n", argv[0]);
+    return 1;
+  }
+
+  std::string_view backend_name = "null";
+  size_t number_of_threads = 1u;
+
+  for(int i = 2; i < argc; i++) {
+    const std::string_view argument = argv[i];
+
+    if(argument.starts_with("--backend=")) {
+      backend_name = argument.substr(std::string_view{"--backend="}.size());
+    } else if(argument.starts_with("--threads=")) {
+      const std::string_view value = argument.substr(std::string_view{"--threads="}.size());
+
+      if(std::from_chars(value.data(), value.data() + value.size(), number_of_threads).ec != std::errc{} || number_of_threads == 0u) {
+        ZEPHYR_PANIC("Invalid number of threads: {}", value);
+      }
+    } else {
+      ZEPHYR_PANIC("Unknown argument: {}", argument);
+    }
+  }
+
+  std::shared_ptr<RenderBackend> render_backend{};
+  SDL_Window* window{};
+
+  if(backend_name == "null") {
+    render_backend = std::make_shared<NullRenderBackend>();
+  } else if(backend_name == "opengl") {
+    #ifdef ZEPHYR_OPENGL
+      window = SDL_CreateWindow("Zephyr Replay (OpenGL)", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1920, 1080, SDL_WINDOW_OPENGL);
+      render_backend = CreateOpenGLRenderBackendForSDL2(window);
+    #else
+      ZEPHYR_PANIC("Zephyr was built without the OpenGL backend");
+    #endif
+  } else {
+    ZEPHYR_PANIC("Unknown render backend: {}", backend_name);
+  }
+
+  // Everything runs on the main thread, so that the timings are not skewed by the hand-off between the game thread and the render thread.
+  render_backend->InitializeContext();
+
+  {
+    SceneJournalPlayer player{argv[1]};
+    RenderScene render_scene{render_backend};
+    render_scene.SetSceneGraph(player.GetSceneGraph());
+
+    std::array<std::vector<f64>, STAGE_COUNT> timings{};
+    std::optional<ThreadPool> thread_pool{};
+    RenderCamera render_camera{};
+    SceneGraph& scene_graph = *player.GetSceneGraph();
+
+    // Single-threaded runs use the serial update paths and must not pay for idle worker threads.
+    if(number_of_threads > 1u) {
+      thread_pool.emplace(number_of_threads);
+    }
+
+    auto time_point = std::chrono::steady_clock::now();
+
+    const auto EndStage = [&](Stage stage) {
+      const auto time_point_now = std::chrono::steady_clock::now();
+      timings[stage].push_back(std::chrono::duration<f64, std::milli>(time_point_now - time_point).count());
+      time_point = time_point_now;
+    };
+
+    while(true) {
+      time_point = std::chrono::steady_clock::now();
+
+      if(!player.ReplayFrame()) {
+        break;
+      }
+      EndStage(STAGE_REPLAY);
+
+      if(number_of_threads > 1u) {
+        scene_graph.UpdateTransforms(*thread_pool);
+      } else {
+        scene_graph.UpdateTransforms();
+      }
+      EndStage(STAGE_UPDATE_TRANSFORMS);
+
+      render_scene.UpdateStage1();
+      scene_graph.ClearScenePatches();
+      EndStage(STAGE_UPDATE_STAGE_1);
+
+      if(number_of_threads > 1u) {
+        render_scene.UpdateStage2(*thread_pool);
+      } else {
+        render_scene.UpdateStage2();
+      }
+      render_scene.GetRenderCamera(render_camera);
+      EndStage(STAGE_UPDATE_STAGE_2);
+
+      render_backend->Render(render_camera, render_scene.GetDynamicRenderBundle(), render_scene.GetDrawList(), render_scene.GetStaticRenderBundles());
+      render_backend->SwapBuffers();
+      EndStage(STAGE_RENDER);
+    }
+
+    fmt::print("replayed {} frames with the {} backend on {} threads\n", timings[STAGE_REPLAY].size(), backend_name, number_of_threads);
+    PrintTimings(timings);
+  }
+
+  render_backend->DestroyContext();
+  render_backend.reset();
+
+  if(window) {
+    SDL_DestroyWindow(window);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+
+#pragma once
+
+#include <zephyr/renderer/backend/render_backend.hpp>
+
+namespace zephyr {
+
+/**
+ * A render backend which does not render anything at all, so that the CPU side of the renderer can be measured in isolation.
+ */
+class NullRenderBackend final : public RenderBackend {
+  public:
+    void InitializeContext() override {}
+    void DestroyContext() override {}
+
+    RenderGeometry* CreateRenderGeometry(RenderGeometryLayout layout, size_t number_of_vertices, size_t number_of_indices) override {
+      return new NullRenderGeometry{layout, m_next_geometry_id++, number_of_vertices, number_of_indices};
+    }
+
+    void UpdateRenderGeometryIndices(RenderGeometry*, std::span<const u8>) override {}
+    void UpdateRenderGeometryVertices(RenderGeometry*, std::span<const u8>) override {}
+    void UpdateRenderGeometryAABB(RenderGeometry*, const Box3&) override {}
+
+    void DestroyRenderGeometry(RenderGeometry* render_geometry) override {
+      delete render_geometry;
+    }
+
+    RenderTexture* CreateRenderTexture(u32, u32) override {
+      return new RenderTexture{};
+    }
+
+    void UpdateRenderTextureData(RenderTexture*, std::span<const u8>) override {}
+
+    void DestroyRenderTexture(RenderTexture* render_texture) override {
+      delete render_texture;
+    }
+
+    void Render(
+      const RenderCamera&,
+      const ResidentRenderBundle&,
+      const DrawList&,
+      const eastl::hash_map<RenderBundleKey, ResidentRenderBundle>&
+    ) override {}
+
+    void SwapBuffers() override {}
+
+  private:
+    class NullRenderGeometry final : public RenderGeometry {
+      public:
+        NullRenderGeometry(RenderGeometryLayout layout, size_t id, size_t number_of_vertices, size_t number_of_indices)
+            : m_layout{layout}
+            , m_id{id}
+            , m_number_of_vertices{number_of_vertices}
+            , m_number_of_indices{number_of_indices} {
+        }
+
+        [[nodiscard]] RenderGeometryLayout GetLayout() const override {
+          return m_layout;
+        }
+
+        [[nodiscard]] size_t GetGeometryID() const override {
+          return m_id;
+        }
+
+        [[nodiscard]] size_t GetNumberOfVertices() const override {
+          return m_number_of_vertices;
+        }
+
+        [[nodiscard]] size_t GetNumberOfIndices() const override {
+          return m_number_of_indices;
+        }
+
+      private:
+        RenderGeometryLayout m_layout;
+        size_t m_id;
+        size_t m_number_of_vertices;
+        size_t m_number_of_indices;
+    };
+
+    size_t m_next_geometry_id{};
+};
+
+} // namespace zephyr
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace zephyr {
+
+/**
+ * An immutable string, which is stored only once per process no matter how often it is used.
+ * Copying and comparing interned strings is as cheap as copying and comparing a pointer, which makes them well suited as hash map keys.
+ * Interned strings are never freed, so they should be used for identifiers such as node names, not for arbitrary text.
+ */
+class InternedString {
+  public:
+    InternedString() = default;
+    InternedString(const char* string) : m_string{Intern(string)} {} // NOLINT(google-explicit-constructor)
+    InternedString(const std::string& string) : m_string{Intern(string)} {} // NOLINT(google-explicit-constructor)
+    InternedString(std::string_view string) : m_string{Intern(string)} {} // NOLINT(google-explicit-constructor)
+
+    /// @returns the interned string equal to a string, without interning the string if it has not been interned before.
+    [[nodiscard]] static std::optional<InternedString> Find(std::string_view string);
+
+    [[nodiscard]] const std::string& Get() const {
+      return m_string ? *m_string : k_empty_string;
+    }
+
+    [[nodiscard]] bool Empty() const {
+      return m_string == nullptr;
+    }
+
+    [[nodiscard]] bool operator==(const InternedString& other) const {
+      return m_string == other.m_string;
+    }
+
+  private:
+    static inline const std::string k_empty_string{};
+
+    explicit InternedString(const std::string* string) : m_string{string} {}
+
+    static const std::string* Intern(std::string_view string);
+
+    const std::string* m_string{}; //< The single instance of the string or nullptr for the empty string
+};
+
+} // namespace zephyr
+
+template<>
+struct std::hash<zephyr::InternedString> {
+  size_t operator()(const zephyr::InternedString& string) const noexcept {
+    return std::hash<const void*>{}(&string.Get());
+  }
+};
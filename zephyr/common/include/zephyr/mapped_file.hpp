@@ -0,0 +1,34 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <filesystem>
+#include <span>
+
+namespace zephyr {
+
+/**
+ * Maps the contents of a file into memory for reading. The operating system pages the contents in on demand,
+ * so mapping even a very large file is cheap and no data is copied until it is actually accessed.
+ */
+class MappedFile : NonCopyable, NonMoveable {
+  public:
+    explicit MappedFile(const std::filesystem::path& path);
+   ~MappedFile();
+
+    [[nodiscard]] std::span<const u8> GetData() const {
+      return {m_data, m_size};
+    }
+
+  private:
+    const u8* m_data{};
+    size_t m_size{};
+
+#ifdef _WIN32
+    void* m_file_handle{};
+    void* m_mapping_handle{};
+#endif
+};
+
+} // namespace zephyr
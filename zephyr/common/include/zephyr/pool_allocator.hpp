@@ -0,0 +1,113 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace zephyr {
+
+/**
+ * Hands out fixed-size blocks of memory, which are carved out of large slabs.
+ * Freed blocks are kept in an intrusive free list and are reused by later allocations.
+ * Slabs are never returned to the system, the pool is meant for objects which are allocated and freed in large numbers.
+ */
+template<size_t block_size, size_t block_alignment>
+class SlabPool : NonCopyable, NonMoveable {
+  public:
+    [[nodiscard]] static SlabPool& Get() {
+      // Intentionally never destroyed: blocks may still be released during static destruction.
+      static SlabPool* pool = new SlabPool{};
+      return *pool;
+    }
+
+    [[nodiscard]] void* Allocate() {
+      std::lock_guard lock_guard{m_mutex};
+
+      if(!m_free_list) {
+        AllocateSlab();
+      }
+
+      FreeBlock* block = m_free_list;
+      m_free_list = block->next;
+      return block;
+    }
+
+    void Release(void* address) {
+      std::lock_guard lock_guard{m_mutex};
+
+      FreeBlock* block = (FreeBlock*)address;
+      block->next = m_free_list;
+      m_free_list = block;
+    }
+
+  private:
+    struct FreeBlock {
+      FreeBlock* next;
+    };
+
+    static constexpr size_t k_alignment = std::max(block_alignment, alignof(FreeBlock));
+    static constexpr size_t k_block_size = (std::max(block_size, sizeof(FreeBlock)) + k_alignment - 1u) & ~(k_alignment - 1u);
+    static constexpr size_t k_blocks_per_slab = 256u;
+
+    SlabPool() = default;
+
+    void AllocateSlab() {
+      std::byte* slab = (std::byte*)::operator new(k_block_size * k_blocks_per_slab, std::align_val_t{k_alignment});
+      m_slabs.push_back(slab);
+
+      // Link the blocks in address order, so that consecutive allocations end up next to each other in memory.
+      for(size_t i = k_blocks_per_slab; i > 0u; i--) {
+        FreeBlock* block = (FreeBlock*)(slab + (i - 1u) * k_block_size);
+        block->next = m_free_list;
+        m_free_list = block;
+      }
+    }
+
+    std::mutex m_mutex{};
+    FreeBlock* m_free_list{};
+    std::vector<std::byte*> m_slabs{};
+};
+
+/**
+ * Standard allocator, which serves single-object allocations from a SlabPool shared by all objects of the same size and alignment.
+ * Array allocations are forwarded to std::allocator. Mainly useful with std::allocate_shared(), which then places
+ * the object and its control block into a single pooled block.
+ */
+template<typename T>
+class PoolAllocator {
+  public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {} // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] T* allocate(size_t n) {
+      if(n == 1u) {
+        return (T*)SlabPool<sizeof(T), alignof(T)>::Get().Allocate();
+      }
+      return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* address, size_t n) {
+      if(n == 1u) {
+        SlabPool<sizeof(T), alignof(T)>::Get().Release(address);
+      } else {
+        std::allocator<T>{}.deallocate(address, n);
+      }
+    }
+
+    template<typename U>
+    [[nodiscard]] bool operator==(const PoolAllocator<U>&) const {
+      return true;
+    }
+};
+
+} // namespace zephyr
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <array>
+#include <vector>
+
+namespace zephyr {
+
+/**
+ * Sort values by 64-bit keys with a stable least significant digit radix sort, which sorts by one byte of the keys per pass.
+ * Passes over bytes which are the same in all keys are skipped, so keys which only differ in a few bytes sort in just as few passes.
+ * @param values the values to sort, which hold the sorted values afterwards
+ * @param scratch a buffer of the same type, which is resized to the number of values and holds undefined values afterwards
+ * @param get_key a function which returns the u64 key of a value
+ */
+template<typename T, typename GetKey>
+void RadixSort(std::vector<T>& values, std::vector<T>& scratch, GetKey&& get_key) {
+  const size_t number_of_values = values.size();
+
+  if(number_of_values <= 1u) {
+    return;
+  }
+
+  // Count the occurrences of each byte value in all bytes of the keys at once, which saves a pass over the values per byte.
+  std::array<std::array<size_t, 256>, 8> histograms{};
+
+  for(const T& value : values) {
+    const u64 key = get_key(value);
+
+    for(int byte = 0; byte < 8; byte++) {
+      histograms[byte][(key >> (byte * 8)) & 0xFFu]++;
+    }
+  }
+
+  scratch.resize(number_of_values);
+
+  for(int byte = 0; byte < 8; byte++) {
+    std::array<size_t, 256>& histogram = histograms[byte];
+
+    if(histogram[(get_key(values[0]) >> (byte * 8)) & 0xFFu] == number_of_values) {
+      continue;
+    }
+
+    // Turn the counts into the offsets at which the values with each byte value begin.
+    size_t offset = 0u;
+
+    for(size_t& count : histogram) {
+      const size_t number_of_values_with_byte = count;
+      count = offset;
+      offset += number_of_values_with_byte;
+    }
+
+    for(const T& value : values) {
+      scratch[histogram[(get_key(value) >> (byte * 8)) & 0xFFu]++] = value;
+    }
+
+    values.swap(scratch);
+  }
+}
+
+} // namespace zephyr
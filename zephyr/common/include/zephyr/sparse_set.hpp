@@ -0,0 +1,91 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <zephyr/panic.hpp>
+#include <concepts>
+#include <span>
+#include <vector>
+
+namespace zephyr {
+
+/**
+ * A set of small integer keys, i.e. entity IDs, with O(1) insertion, removal and lookup.
+ * The keys are kept in a dense array, which can be iterated without any gaps. A sparse array indexed by the key
+ * maps each key to its position in the dense array, so it grows with the largest key rather than with the number of keys.
+ * Removal moves the last key into the gap, so the order of the keys is not retained.
+ */
+template<std::unsigned_integral Key>
+class SparseSet {
+  public:
+    [[nodiscard]] bool Contains(Key key) const {
+      return key < m_sparse.size() && m_sparse[key] != k_not_contained;
+    }
+
+    void Insert(Key key) {
+      if(Contains(key)) {
+        ZEPHYR_PANIC("The key {} is in the set already", key);
+      }
+
+      if(key >= m_sparse.size()) {
+        m_sparse.resize(key + 1u, k_not_contained);
+      }
+
+      m_sparse[key] = (u32)m_dense.size();
+      m_dense.push_back(key);
+    }
+
+    void Remove(Key key) {
+      if(!Contains(key)) {
+        ZEPHYR_PANIC("The key {} is not in the set", key);
+      }
+
+      const u32 index = m_sparse[key];
+      const Key last_key = m_dense.back();
+
+      m_dense[index] = last_key;
+      m_sparse[last_key] = index;
+      m_dense.pop_back();
+      m_sparse[key] = k_not_contained;
+    }
+
+    void Clear() {
+      // Only reset the sparse entries in use, which is cheaper than clearing the whole sparse array for small sets.
+      for(const Key key : m_dense) {
+        m_sparse[key] = k_not_contained;
+      }
+      m_dense.clear();
+    }
+
+    [[nodiscard]] bool IsEmpty() const {
+      return m_dense.empty();
+    }
+
+    [[nodiscard]] size_t Size() const {
+      return m_dense.size();
+    }
+
+    [[nodiscard]] Key operator[](size_t index) const {
+      return m_dense[index];
+    }
+
+    /// @returns the keys in the set, in no particular order.
+    [[nodiscard]] std::span<const Key> GetKeys() const {
+      return m_dense;
+    }
+
+    [[nodiscard]] auto begin() const {
+      return m_dense.begin();
+    }
+
+    [[nodiscard]] auto end() const {
+      return m_dense.end();
+    }
+
+  private:
+    static constexpr u32 k_not_contained = ~0u;
+
+    std::vector<Key> m_dense{};
+    std::vector<u32> m_sparse{}; //< Maps each key to its index in m_dense
+};
+
+} // namespace zephyr
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zephyr {
+
+/**
+ * A fixed-size pool of worker threads for fork-join style parallelism.
+ * The thread calling into the pool participates in the work and only returns once all work is done.
+ * A pool may only be used by one calling thread at a time.
+ */
+class ThreadPool : NonCopyable, NonMoveable {
+  public:
+    /**
+     * @param number_of_threads the total number of threads working on a job, including the calling thread.
+     *                          Zero selects the number of hardware threads.
+     */
+    explicit ThreadPool(size_t number_of_threads = 0u);
+   ~ThreadPool();
+
+    /// @returns the total number of threads working on a job, including the calling thread.
+    [[nodiscard]] size_t GetNumberOfThreads() const {
+      return m_worker_threads.size() + 1u;
+    }
+
+    /**
+     * Run a functor for each index in [0, count) and wait for all invocations to complete.
+     * The functor is invoked concurrently from multiple threads, with the index of the invocation
+     * and the index of the invoking thread (in [0, GetNumberOfThreads())).
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t index, size_t thread_index)>& functor);
+
+  private:
+    void WorkerThreadMain(size_t thread_index);
+    void RunJob(size_t thread_index);
+
+    std::vector<std::thread> m_worker_threads{};
+    std::mutex m_mutex{};
+    std::condition_variable m_job_available{};
+    std::condition_variable m_job_done{};
+    bool m_shutdown{false};
+
+    // State of the current job:
+    u64 m_job_id{0u};
+    size_t m_job_count{0u};
+    const std::function<void(size_t, size_t)>* m_job_functor{};
+    std::atomic<size_t> m_job_next_index{0u};
+    size_t m_job_active_workers{0u};
+};
+
+} // namespace zephyr
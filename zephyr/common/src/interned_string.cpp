@@ -0,0 +1,60 @@
+#include <zephyr/interned_string.hpp>
+#include <mutex>
+#include <unordered_set>
+
+namespace zephyr {
+
+namespace {
+
+struct StringHash {
+  using is_transparent = void;
+
+  size_t operator()(std::string_view string) const {
+    return std::hash<std::string_view>{}(string);
+  }
+};
+
+struct StringPool {
+  std::mutex mutex{};
+  std::unordered_set<std::string, StringHash, std::equal_to<>> strings{}; //< Node-based, so the addresses of the strings are stable
+};
+
+StringPool& GetStringPool() {
+  // Intentionally never destroyed: interned strings may still be referenced during static destruction.
+  static StringPool* string_pool = new StringPool{};
+  return *string_pool;
+}
+
+} // anonymous namespace
+
+std::optional<InternedString> InternedString::Find(std::string_view string) {
+  if(string.empty()) {
+    return InternedString{};
+  }
+
+  StringPool& string_pool = GetStringPool();
+  std::lock_guard lock_guard{string_pool.mutex};
+
+  const auto match = string_pool.strings.find(string);
+  if(match == string_pool.strings.end()) {
+    return std::nullopt;
+  }
+  return InternedString{&*match};
+}
+
+const std::string* InternedString::Intern(std::string_view string) {
+  if(string.empty()) {
+    return nullptr;
+  }
+
+  StringPool& string_pool = GetStringPool();
+  std::lock_guard lock_guard{string_pool.mutex};
+
+  auto match = string_pool.strings.find(string);
+  if(match == string_pool.strings.end()) {
+    match = string_pool.strings.emplace(string).first;
+  }
+  return &*match;
+}
+
+} // namespace zephyr
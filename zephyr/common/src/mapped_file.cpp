@@ -0,0 +1,94 @@
+#include <zephyr/mapped_file.hpp>
+#include <zephyr/panic.hpp>
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace zephyr {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  m_file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(m_file_handle == INVALID_HANDLE_VALUE) {
+    ZEPHYR_PANIC("Failed to open file: {}", path.string());
+  }
+
+  LARGE_INTEGER file_size{};
+  if(!GetFileSizeEx(m_file_handle, &file_size)) {
+    ZEPHYR_PANIC("Failed to query the size of file: {}", path.string());
+  }
+  m_size = (size_t)file_size.QuadPart;
+
+  // Empty files cannot be mapped, but there is nothing to read from them anyway.
+  if(m_size == 0u) {
+    return;
+  }
+
+  m_mapping_handle = CreateFileMappingW(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if(!m_mapping_handle) {
+    ZEPHYR_PANIC("Failed to create a file mapping for file: {}", path.string());
+  }
+
+  m_data = (const u8*)MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+  if(!m_data) {
+    ZEPHYR_PANIC("Failed to map file: {}", path.string());
+  }
+}
+
+MappedFile::~MappedFile() {
+  if(m_data) {
+    UnmapViewOfFile(m_data);
+  }
+
+  if(m_mapping_handle) {
+    CloseHandle(m_mapping_handle);
+  }
+
+  CloseHandle(m_file_handle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  const int file_descriptor = open(path.c_str(), O_RDONLY);
+  if(file_descriptor == -1) {
+    ZEPHYR_PANIC("Failed to open file: {}", path.string());
+  }
+
+  struct stat file_status{};
+  if(fstat(file_descriptor, &file_status) == -1) {
+    ZEPHYR_PANIC("Failed to query the size of file: {}", path.string());
+  }
+  m_size = (size_t)file_status.st_size;
+
+  // Empty files cannot be mapped, but there is nothing to read from them anyway.
+  if(m_size > 0u) {
+    void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if(address == MAP_FAILED) {
+      ZEPHYR_PANIC("Failed to map file: {}", path.string());
+    }
+    m_data = (const u8*)address;
+  }
+
+  // The mapping keeps a reference to the file, so the descriptor is not needed anymore.
+  close(file_descriptor);
+}
+
+MappedFile::~MappedFile() {
+  if(m_data) {
+    munmap((void*)m_data, m_size);
+  }
+}
+
+#endif
+
+} // namespace zephyr
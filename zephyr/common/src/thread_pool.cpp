@@ -0,0 +1,96 @@
+#include <zephyr/thread_pool.hpp>
+#include <algorithm>
+
+namespace zephyr {
+
+ThreadPool::ThreadPool(size_t number_of_threads) {
+  if(number_of_threads == 0u) {
+    number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  for(size_t thread_index = 1u; thread_index < number_of_threads; thread_index++) {
+    m_worker_threads.emplace_back([this, thread_index] { WorkerThreadMain(thread_index); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock_guard{m_mutex};
+    m_shutdown = true;
+  }
+  m_job_available.notify_all();
+
+  for(std::thread& worker_thread : m_worker_threads) {
+    worker_thread.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, size_t)>& functor) {
+  if(count == 0u) {
+    return;
+  }
+
+  if(count == 1u || m_worker_threads.empty()) {
+    for(size_t index = 0u; index < count; index++) {
+      functor(index, 0u);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard lock_guard{m_mutex};
+    m_job_id++;
+    m_job_count = count;
+    m_job_functor = &functor;
+    m_job_next_index = 0u;
+    m_job_active_workers = m_worker_threads.size();
+  }
+  m_job_available.notify_all();
+
+  RunJob(0u);
+
+  // Wait for all worker threads to be done with the job, the functor must not be referenced after we return.
+  std::unique_lock lock{m_mutex};
+  m_job_done.wait(lock, [this] { return m_job_active_workers == 0u; });
+  m_job_functor = nullptr;
+}
+
+void ThreadPool::WorkerThreadMain(size_t thread_index) {
+  u64 last_job_id = 0u;
+
+  while(true) {
+    {
+      std::unique_lock lock{m_mutex};
+      m_job_available.wait(lock, [&] { return m_shutdown || m_job_id != last_job_id; });
+      if(m_shutdown) {
+        return;
+      }
+      last_job_id = m_job_id;
+    }
+
+    RunJob(thread_index);
+
+    bool last_worker_done;
+    {
+      std::lock_guard lock_guard{m_mutex};
+      last_worker_done = --m_job_active_workers == 0u;
+    }
+    if(last_worker_done) {
+      m_job_done.notify_one();
+    }
+  }
+}
+
+void ThreadPool::RunJob(size_t thread_index) {
+  const std::function<void(size_t, size_t)>& functor = *m_job_functor;
+
+  while(true) {
+    const size_t index = m_job_next_index.fetch_add(1u, std::memory_order_relaxed);
+    if(index >= m_job_count) {
+      break;
+    }
+    functor(index, thread_index);
+  }
+}
+
+} // namespace zephyr
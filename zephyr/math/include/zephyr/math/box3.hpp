@@ -23,12 +23,44 @@ namespace zephyr {
  */
 class Box3 {
   public:
+    Box3() = default;
+
+    /**
+     * Construct a bounding box from its minimum and maximum vectors.
+     *
+     * @param min the lower-left vertex
+     * @param max the upper-right vertex
+     */
+    Box3(Vector3 const& min, Vector3 const& max) : min{min}, max{max} {}
+
+    /**
+     * Construct an empty bounding box, which encloses no points at all.
+     * An empty bounding box is the identity of {@link #Union}.
+     *
+     * @return the empty bounding box
+     */
+    [[nodiscard]] static auto Empty() -> Box3 {
+      return Box3{
+        Vector3{+std::numeric_limits<float>::infinity(), +std::numeric_limits<float>::infinity(), +std::numeric_limits<float>::infinity()},
+        Vector3{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()}
+      };
+    }
+
     [[nodiscard]] auto Min() -> Vector3& { return min; }
     [[nodiscard]] auto Max() -> Vector3& { return max; }
 
     [[nodiscard]] auto Min() const -> Vector3 const& { return min; }
     [[nodiscard]] auto Max() const -> Vector3 const& { return max; }
 
+    /**
+     * Calculate whether this bounding box is empty, i.e. its minimum exceeds its maximum on at least one axis.
+     *
+     * @return true if the bounding box is empty
+     */
+    [[nodiscard]] bool IsEmpty() const {
+      return min.X() > max.X() || min.Y() > max.Y() || min.Z() > max.Z();
+    }
+
     /**
      * Apply a matrix transform on each vertex of this bounding box.
      * Because the new bounding box must be axis-aligned new mininum and maximum
@@ -83,6 +115,49 @@ class Box3 {
       return box;
     }
 
+    /**
+     * Compute the smallest bounding box that encloses both this and another bounding box.
+     *
+     * @param other the other bounding box
+     * @return the enclosing bounding box
+     */
+    [[nodiscard]] auto Union(Box3 const& other) const -> Box3 {
+      return Box3{
+        Vector3{std::min(min.X(), other.min.X()), std::min(min.Y(), other.min.Y()), std::min(min.Z(), other.min.Z())},
+        Vector3{std::max(max.X(), other.max.X()), std::max(max.Y(), other.max.Y()), std::max(max.Z(), other.max.Z())}
+      };
+    }
+
+    /**
+     * Calculate whether another bounding box is fully contained within this bounding box.
+     *
+     * @param other the other bounding box
+     * @return true if the other bounding box is fully inside this bounding box
+     */
+    [[nodiscard]] bool Contains(Box3 const& other) const {
+      for (int i = 0; i < 3; i++) {
+        if (other.min[i] < min[i] || other.max[i] > max[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Calculate whether this bounding box overlaps with another bounding box.
+     *
+     * @param other the other bounding box
+     * @return true if the bounding boxes overlap
+     */
+    [[nodiscard]] bool Intersects(Box3 const& other) const {
+      for (int i = 0; i < 3; i++) {
+        if (other.max[i] < min[i] || other.min[i] > max[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
   private:
     Vector3 min; /**< the lower-left vertex */
     Vector3 max; /**< the upper-right vertex */
@@ -9,6 +9,7 @@
 #include <zephyr/integer.hpp>
 #include <EASTL/hash_map.h>
 #include <span>
+#include <vector>
 
 namespace zephyr {
 
@@ -85,6 +86,41 @@ class RenderBackend {
       u64 entity_id;
     };
 
+    struct RenderBundleItemRange {
+      u32 first_item;
+      u32 number_of_items;
+    };
+
+    /**
+     * A render bundle which the backend keeps resident in GPU memory. If the backend holds the previous version of the bundle,
+     * it only uploads the items in the dirty ranges. Otherwise, i.e. for the first upload, it uploads all items.
+     */
+    struct ResidentRenderBundle {
+      std::vector<RenderBundleItem> items{};
+      std::vector<RenderBundleItemRange> dirty_ranges{}; //< Sorted, disjoint ranges of the items modified since the previous version
+      u64 version{}; //< Must be incremented whenever the items are modified
+    };
+
+    /**
+     * The items of the dynamic render bundle to draw in a frame, ordered by 64-bit sort keys. From the most to the least significant bit, a sort key packs:
+     *   [63:56] the geometry layout
+     *   [55]    whether the geometry uses an index buffer
+     *   [47:24] the material ID
+     *   [23:0]  the quantized view-space depth
+     * Thus the items of each render bundle form a contiguous range, in which they are grouped by material and ordered front-to-back.
+     */
+    struct DrawList {
+      struct Range {
+        RenderBundleKey key;
+        u32 first_item;
+        u32 number_of_items;
+      };
+
+      std::vector<u32> items{}; //< Indices of the items in the dynamic render bundle
+      std::vector<Range> ranges{}; //< The ranges of items which share a render bundle key, in the order of their sort keys
+      u64 version{}; //< Incremented whenever the item indices change
+    };
+
     virtual ~RenderBackend() = default;
 
     /// Needs to be called from the render thread before performing any render operations.
@@ -104,7 +140,12 @@ class RenderBackend {
     virtual void DestroyRenderTexture(RenderTexture* render_texture) = 0;
 
     /// Just a quick thing for testing the rendering.
-    virtual void Render(const RenderCamera& render_camera, const eastl::hash_map<RenderBundleKey, std::vector<RenderBundleItem>>& render_bundles) = 0;
+    virtual void Render(
+      const RenderCamera& render_camera,
+      const ResidentRenderBundle& render_bundle,
+      const DrawList& draw_list,
+      const eastl::hash_map<RenderBundleKey, ResidentRenderBundle>& static_render_bundles
+    ) = 0;
 
     /// Start rendering the next frame.
     virtual void SwapBuffers() = 0;
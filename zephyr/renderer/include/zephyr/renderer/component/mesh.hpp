@@ -12,6 +12,10 @@ struct MeshComponent : Component {
   MeshComponent() = default;
   MeshComponent(std::shared_ptr<Geometry> geometry, std::shared_ptr<Material> material) : geometry{std::move(geometry)}, material{std::move(material)} {}
 
+  [[nodiscard]] Box3 GetLocalBounds() const override {
+    return geometry ? geometry->GetAABB() : Box3::Empty();
+  }
+
   std::shared_ptr<Geometry> geometry;
   std::shared_ptr<Material> material;
 };
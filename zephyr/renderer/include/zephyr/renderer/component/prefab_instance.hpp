@@ -0,0 +1,20 @@
+#pragma once
+
+#include <zephyr/renderer/prefab.hpp>
+#include <zephyr/scene/component.hpp>
+#include <memory>
+
+namespace zephyr {
+
+struct PrefabInstanceComponent : Component {
+  PrefabInstanceComponent() = default;
+  explicit PrefabInstanceComponent(std::shared_ptr<const Prefab> prefab) : prefab{std::move(prefab)} {}
+
+  [[nodiscard]] Box3 GetLocalBounds() const override {
+    return prefab ? prefab->GetBounds() : Box3::Empty();
+  }
+
+  std::shared_ptr<const Prefab> prefab;
+};
+
+} // namespace zephyr
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <zephyr/math/box3.hpp>
+#include <zephyr/math/matrix4.hpp>
+#include <zephyr/renderer/resource/geometry.hpp>
+#include <zephyr/renderer/resource/material.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace zephyr {
+
+class SceneNode;
+
+/**
+ * An immutable template of meshes, which can be placed into a scene any number of times via a PrefabInstanceComponent.
+ * All placements share the geometries and materials of the prefab and each placement occupies only a single scene node,
+ * so that memory usage and mounting costs scale with the unique content rather than with the number of placements.
+ */
+class Prefab : NonCopyable, NonMoveable {
+  public:
+    struct Mesh {
+      std::shared_ptr<Geometry> geometry;
+      std::shared_ptr<Material> material;
+      Matrix4 local_to_prefab; //< The transform of the mesh relative to the prefab root
+    };
+
+    explicit Prefab(std::vector<Mesh> meshes);
+
+    /**
+     * Create a prefab from the visible meshes of a subtree, for example a freshly loaded glTF model.
+     * The transform of the subtree root itself is not part of the prefab, since it is supplied by each placement.
+     */
+    static std::shared_ptr<const Prefab> FromSubtree(const SceneNode* root);
+
+    [[nodiscard]] std::span<const Mesh> GetMeshes() const {
+      return m_meshes;
+    }
+
+    /// @returns the bounds of all meshes in the space of the prefab root.
+    [[nodiscard]] const Box3& GetBounds() const {
+      return m_bounds;
+    }
+
+  private:
+    std::vector<Mesh> m_meshes;
+    Box3 m_bounds{Box3::Empty()};
+};
+
+} // namespace zephyr
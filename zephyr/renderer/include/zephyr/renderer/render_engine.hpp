@@ -4,6 +4,7 @@
 #include <zephyr/renderer/backend/render_backend.hpp>
 #include <zephyr/renderer/render_scene.hpp>
 #include <zephyr/scene/scene_graph.hpp>
+#include <zephyr/thread_pool.hpp>
 #include <atomic>
 #include <semaphore>
 #include <thread>
@@ -34,6 +35,7 @@ class RenderEngine {
 
     RenderScene m_render_scene; //< Representation of the scene graph that is internal to the render engine.
     RenderCamera m_render_camera{};
+    ThreadPool m_render_thread_pool; //< Helps the render thread with stage 2, while the caller thread may be using its own thread pool
 };
 
 } // namespace zephyr
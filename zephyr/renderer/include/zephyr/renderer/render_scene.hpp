@@ -7,11 +7,15 @@
 #include <zephyr/renderer/engine/geometry_cache.hpp>
 #include <zephyr/renderer/engine/material_cache.hpp>
 #include <zephyr/renderer/engine/texture_cache.hpp>
+#include <zephyr/renderer/prefab.hpp>
 #include <zephyr/renderer/resource/geometry.hpp>
 #include <zephyr/renderer/resource/material.hpp>
 #include <zephyr/renderer/resource/texture_2d.hpp>
 #include <zephyr/scene/scene_graph.hpp>
+#include <zephyr/float.hpp>
 #include <zephyr/integer.hpp>
+#include <zephyr/sparse_set.hpp>
+#include <zephyr/thread_pool.hpp>
 #include <EASTL/hash_map.h>
 #include <EASTL/hash_set.h>
 #include <memory>
@@ -29,25 +33,48 @@ class RenderScene {
 
     // Render Thread API:
     void UpdateStage2();
+
+    /**
+     * Like UpdateStage2(), but apply the transform changes to the render bundle items in parallel, which dominate the cost of stage 2 in animated scenes.
+     * The thread pool must not be used by the game thread at the same time.
+     */
+    void UpdateStage2(ThreadPool& thread_pool);
     void GetRenderCamera(RenderCamera& out_render_camera);
-    [[nodiscard]] const eastl::hash_map<RenderBackend::RenderBundleKey, std::vector<RenderBackend::RenderBundleItem>>& GetRenderBundles();
+    [[nodiscard]] const RenderBackend::ResidentRenderBundle& GetDynamicRenderBundle();
+    [[nodiscard]] const RenderBackend::DrawList& GetDrawList();
+    [[nodiscard]] const eastl::hash_map<RenderBackend::RenderBundleKey, RenderBackend::ResidentRenderBundle>& GetStaticRenderBundles();
 
   private:
     using Entity = u32;
     using EntityID = u64;
 
+    static constexpr EntityID k_no_entity = ~(EntityID)0u;
+    static constexpr size_t k_transform_patch_batches_per_thread = 4u;
+    static constexpr size_t k_min_transform_patches_per_batch = 256u;
+    static constexpr u32 k_max_dirty_range_gap = 16u; //< Dirty ranges which are at most this many items apart are uploaded as one range
+    static constexpr int k_sort_key_render_bundle_shift = 55; //< The render bundle key occupies the sort key bits above this one, @see RenderBackend::DrawList
+    static constexpr int k_sort_key_geometry_layout_shift = 56; //< The geometry layout occupies the eight most significant bits of a sort key
+
     enum ComponentFlag : Entity {
       COMPONENT_FLAG_MESH = 1ul << 0,
-      COMPONENT_FLAG_CAMERA = 1ul << 1
+      COMPONENT_FLAG_CAMERA = 1ul << 1,
+      COMPONENT_FLAG_PREFAB_INSTANCE = 1ul << 2
     };
 
+    /**
+     * World matrices are not copied into the render scene, instead they are read from the world matrix snapshot of the scene graph when needed.
+     * The entities of prefab meshes refer to the world matrix of the instance node and apply the transform of the mesh within the prefab.
+     */
     struct Transform {
-      Matrix4 local_to_world;
+      u32 world_matrix_index; //< The index of the node's world matrix in the world matrix snapshot
+      bool is_prefab_mesh;
+      Matrix4 local_to_prefab;
     };
 
     struct Mesh {
       const Geometry* geometry;
       const Material* material;
+      bool is_static;
     };
 
     struct Camera {
@@ -55,6 +82,11 @@ class RenderScene {
       Frustum frustum;
     };
 
+    struct PrefabInstance {
+      const Prefab* prefab;
+      std::vector<EntityID> mesh_entities; //< One node-less entity per mesh of the prefab, in the order of Prefab::GetMeshes()
+    };
+
     struct RenderScenePatch {
       enum class Type : u8 {
         MeshMounted,
@@ -66,19 +98,48 @@ class RenderScene {
       EntityID entity_id;
     };
 
+    /**
+     * The location of the render bundle item of a mesh entity. Static render bundles are referenced directly instead of by their key,
+     * which saves the hash map lookups when patching the item. This is safe, because the values of the static render bundle map
+     * never move in memory and static render bundles are never erased.
+     */
     struct RenderBundleItemLocation {
-      RenderBackend::RenderBundleKey key;
-      size_t index;
+      RenderBackend::ResidentRenderBundle* render_bundle{}; //< The dynamic or a static render bundle, nullptr if the entity has no render bundle item
+      u32 index{};
+      u64 sort_key{}; //< The render bundle and material bits of the item's sort key, the depth is added when building the draw list
+    };
+
+    struct DrawListEntry {
+      u64 sort_key;
+      u32 item; //< The index of the item in m_render_bundle
     };
 
+    [[nodiscard]] static u64 GetSortKey(const RenderBackend::RenderBundleKey& render_bundle_key, u32 material_id);
+    [[nodiscard]] static u64 GetSortKeyDepth(f32 view_depth);
+    [[nodiscard]] static RenderBackend::RenderBundleKey GetRenderBundleKey(u64 sort_key);
+
+    void MarkRenderBundleItemDirty(RenderBackend::ResidentRenderBundle& render_bundle, u32 index);
+    void ClearDirtyRanges();
+    void CoalesceDirtyRanges();
+
+    void ApplyRenderScenePatch(const RenderScenePatch& render_scene_patch);
+    void ApplyTransformChanged(EntityID entity_id);
+
     void RebuildScene();
     void PatchScene();
     void PatchNodeMounted(SceneNode* node);
-    void PatchNodeRemoved(SceneNode* node);
-    void PatchNodeComponentMounted(SceneNode* node, std::type_index component_type);
-    void PatchNodeComponentRemoved(SceneNode* node, std::type_index component_type);
+    void PatchNodeRemoved(SceneNodeHandle node_handle);
+    void PatchNodeComponentMounted(SceneNode* node, ComponentTypeID component_type);
+    void PatchNodeComponentRemoved(SceneNodeHandle node_handle, ComponentTypeID component_type);
     void PatchNodeTransformChanged(SceneNode* node);
+    void AddMeshToEntity(EntityID entity_id, const Geometry* geometry, const Material* material, bool is_static);
+    void RemoveMeshFromEntity(EntityID entity_id);
+    void CullScene();
+    void BuildDrawList();
+
+    [[nodiscard]] Matrix4 GetEntityWorldMatrix(EntityID entity_id) const;
 
+    [[nodiscard]] EntityID GetEntityForNode(u32 node_handle_index) const;
     EntityID GetOrCreateEntityForNode(const SceneNode* node);
 
     EntityID CreateEntity();
@@ -90,7 +151,8 @@ class RenderScene {
     MaterialCache m_material_cache;
 
     std::shared_ptr<SceneGraph> m_current_scene_graph{};
-    eastl::hash_map<const SceneNode*, EntityID> m_node_entity_map{};
+    std::span<const Matrix4> m_world_matrices{}; //< The world matrix snapshot taken by the scene graph for the frame prepared in stage 1
+    std::vector<EntityID> m_node_entity_table{}; //< Maps node handle indices, which the scene graph keeps dense, to entities
     bool m_require_full_rebuild{};
 
     std::vector<Entity> m_entities{};
@@ -98,12 +160,29 @@ class RenderScene {
     std::vector<Transform> m_components_transform{};
     std::vector<Mesh> m_components_mesh{};
     std::vector<Camera> m_components_camera{};
-    std::vector<EntityID> m_view_mesh{};
-    std::vector<EntityID> m_view_camera{};
+    std::vector<PrefabInstance> m_components_prefab_instance{};
+    std::vector<RenderBundleItemLocation> m_components_render_item_location{}; //< Written by the render scene patches in stage 2
+    SparseSet<EntityID> m_view_mesh{}; //< All entities with a mesh component
+    SparseSet<EntityID> m_view_camera{}; //< All entities with a camera component
 
     std::vector<RenderScenePatch> m_render_scene_patches{};
-    eastl::hash_map<EntityID, RenderBundleItemLocation> m_entity_to_render_item_location{};
-    eastl::hash_map<RenderBackend::RenderBundleKey, std::vector<RenderBackend::RenderBundleItem>> m_render_bundles{};
+    std::vector<EntityID> m_transform_patches{}; //< Scratch buffer for the entities with transform changes when applying them in parallel
+    std::vector<std::vector<EntityID>> m_thread_local_dirty_items{}; //< Entities whose items were written by each thread, which are marked dirty afterwards
+    RenderBackend::ResidentRenderBundle m_render_bundle{}; //< The items of all dynamic meshes, in no particular order
+    eastl::hash_map<RenderBackend::RenderBundleKey, RenderBackend::ResidentRenderBundle> m_static_render_bundles{}; //< Render bundles of nodes marked as static
+    std::vector<RenderBackend::ResidentRenderBundle*> m_dirty_render_bundles{}; //< Render bundles with dirty ranges, which are cleared in the next stage 2
+    std::vector<RenderBackend::RenderBundleItemRange> m_dirty_range_sort_scratch{};
+
+    // Hierarchical CPU culling of dynamic meshes:
+    std::vector<const SceneNode*> m_cull_stack{};
+    std::vector<EntityID> m_visible_mesh_entities{}; //< Dynamic mesh entities in subtrees which intersect the view frustum, found in stage 1
+    Matrix4 m_cull_view{}; //< The view matrix used for culling in stage 1, which the draw list is sorted by in stage 2
+
+    // Draw list of the visible dynamic meshes, built in stage 2:
+    std::vector<DrawListEntry> m_draw_list_entries{};
+    std::vector<DrawListEntry> m_draw_list_sort_scratch{};
+    std::vector<u32> m_draw_list_items{}; //< The item indices of the draw list being built, which replace those of m_draw_list if they differ
+    RenderBackend::DrawList m_draw_list{};
 
     // Temporary, texture test:
     std::unique_ptr<Texture2D> m_test_texture{};
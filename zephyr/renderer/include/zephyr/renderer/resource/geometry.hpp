@@ -133,10 +133,18 @@ class Geometry final : public Resource {
       return {(const u8*)m_index_data, sizeof(u32) * m_number_of_indices};
     }
 
+    [[nodiscard]] std::span<u8> GetRawIndexData() {
+      return {(u8*)m_index_data, sizeof(u32) * m_number_of_indices};
+    }
+
     [[nodiscard]] std::span<const u8> GetRawVertexData() const {
       return {(const u8*)m_vertex_data, m_vertex_stride * m_number_of_vertices};
     }
 
+    [[nodiscard]] std::span<u8> GetRawVertexData() {
+      return {(u8*)m_vertex_data, m_vertex_stride * m_number_of_vertices};
+    }
+
     [[nodiscard]] const Box3& GetAABB() const {
       UpdateAABB();
       return m_aabb;
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <zephyr/math/box3.hpp>
+#include <zephyr/math/frustum.hpp>
+#include <zephyr/math/vector.hpp>
+#include <zephyr/scene/scene_graph.hpp>
+#include <zephyr/float.hpp>
+#include <zephyr/integer.hpp>
+#include <vector>
+
+namespace zephyr {
+
+class SceneNode;
+
+/**
+ * A dynamic bounding volume hierarchy over the world-space bounds of all visible mesh and prefab instance nodes in a scene graph,
+ * which accelerates spatial queries such as picking or visibility tests.
+ *
+ * The hierarchy is maintained incrementally from the scene patches of each frame. Leaves store slightly enlarged bounds,
+ * so that small movements of a node do not require touching the tree at all. Insertion picks the sibling by a surface area heuristic
+ * and the tree is kept balanced through tree rotations.
+ */
+class SceneBVH {
+  public:
+    /// Build the hierarchy from scratch for all visible mesh and prefab instance nodes in a scene graph.
+    void Rebuild(const SceneGraph& scene_graph);
+
+    /// Apply the scene patches of the current frame. Must be called each frame before the scene patches are cleared.
+    void ApplyScenePatches(SceneGraph& scene_graph);
+
+    /// Find all nodes whose bounds are at least partially inside of a frustum.
+    void QueryFrustum(const Frustum& frustum, std::vector<SceneNodeHandle>& out_nodes) const;
+
+    /// Find all nodes whose bounds overlap with a box.
+    void QueryBox(const Box3& box, std::vector<SceneNodeHandle>& out_nodes) const;
+
+    /// Find all nodes whose bounds are hit by a ray, within a maximum distance along the (not necessarily normalized) direction.
+    void QueryRay(const Vector3& origin, const Vector3& direction, f32 max_distance, std::vector<SceneNodeHandle>& out_nodes) const;
+
+  private:
+    static constexpr u32 k_null_node = ~0u;
+    static constexpr f32 k_leaf_margin = 0.1f;
+
+    struct Node {
+      Box3 box{};
+      u32 parent{k_null_node}; //< The parent node or the next free node, if the node is on the free list
+      u32 children[2]{k_null_node, k_null_node};
+      s32 height{}; //< Zero for leaves
+      SceneNodeHandle scene_node{}; //< The scene node referenced by a leaf
+    };
+
+    [[nodiscard]] bool IsLeaf(u32 index) const {
+      return m_nodes[index].children[0] == k_null_node;
+    }
+
+    template<typename Predicate>
+    void Query(const Predicate& predicate, std::vector<SceneNodeHandle>& out_nodes) const;
+
+    void InsertOrUpdate(const SceneNode* node);
+    void Remove(SceneNodeHandle handle);
+
+    u32 AllocateNode();
+    void FreeNode(u32 index);
+    void InsertLeaf(u32 leaf);
+    void RemoveLeaf(u32 leaf);
+    void RefitAncestors(u32 index);
+    u32 Balance(u32 index);
+
+    std::vector<Node> m_nodes{};
+    u32 m_root{k_null_node};
+    u32 m_free_list{k_null_node};
+    std::vector<u32> m_leaf_of_scene_node{}; //< Maps scene node handle indices to their leaf
+};
+
+} // namespace zephyr
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <zephyr/renderer/prefab.hpp>
+#include <zephyr/renderer/resource/geometry.hpp>
+#include <zephyr/renderer/resource/material.hpp>
+#include <zephyr/renderer/resource/texture_2d.hpp>
+#include <zephyr/scene/scene_graph.hpp>
+#include <zephyr/scene/scene_node.hpp>
+#include <zephyr/integer.hpp>
+#include <zephyr/mapped_file.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace zephyr {
+
+/**
+ * Records the scene patches of a scene graph frame by frame into a journal file, which can be replayed by a SceneJournalPlayer.
+ * Each patch is stored together with the state that consumers read when processing it, i.e. the name, flags, transform and components of a node,
+ * as well as the contents of all geometries, materials, textures and prefabs referenced by the components. Resources are written once
+ * and written again whenever their version changes, so the recorder keeps all recorded resources alive until it is destroyed.
+ * Only the mesh, camera and prefab instance components are recorded, since the renderer does not consume any other components.
+ */
+class SceneJournalRecorder : NonCopyable, NonMoveable {
+  public:
+    explicit SceneJournalRecorder(const std::filesystem::path& path);
+
+    /**
+     * Record the scene patches of the current frame. Must be called each frame after SceneGraph::UpdateTransforms() and before the scene patches are cleared.
+     * The first recorded frame captures the full state of the scene graph instead of its patches, so that recording can start at any time.
+     */
+    void RecordFrame(SceneGraph& scene_graph);
+
+  private:
+    enum class ResourceType : u8 {
+      Geometry,
+      Material,
+      Texture
+    };
+
+    struct RecordedResource {
+      std::shared_ptr<const Resource> resource;
+      ResourceType type;
+      u64 version; //< The version of the resource when it was last written
+    };
+
+    void RecordFullState(SceneGraph& scene_graph);
+    void RecordScenePatches(SceneGraph& scene_graph);
+    void RecordChangedResources();
+
+    void WriteNode(u32 type, const SceneNode* node);
+    void WriteResource(u32 id);
+    void WriteRecord(u32 type, std::initializer_list<std::span<const u8>> parts);
+
+    u32 GetResourceID(std::shared_ptr<const Resource> resource, ResourceType type);
+    u32 GetPrefabID(const std::shared_ptr<const Prefab>& prefab);
+
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+    bool m_recorded_full_state{};
+
+    std::unordered_map<const Resource*, u32> m_resource_ids{};
+    std::vector<RecordedResource> m_resources{}; //< All recorded resources, indexed by their ID
+    std::unordered_map<const Prefab*, u32> m_prefab_ids{};
+    std::vector<std::shared_ptr<const Prefab>> m_prefabs{}; //< Prefabs are immutable, so they are written only once
+};
+
+/**
+ * Replays a journal written by SceneJournalRecorder into a scene graph owned by the player. Replaying a frame reconstructs the recorded changes
+ * through the regular scene graph API, so that the scene graph emits equivalent scene patches, which can be fed into any consumer of the scene,
+ * for example a RenderScene. Replaying a journal always yields the same sequence of frames, which makes it suitable for benchmarking.
+ */
+class SceneJournalPlayer : NonCopyable, NonMoveable {
+  public:
+    explicit SceneJournalPlayer(const std::filesystem::path& path);
+
+    [[nodiscard]] const std::shared_ptr<SceneGraph>& GetSceneGraph() const {
+      return m_scene_graph;
+    }
+
+    /**
+     * Apply the changes of the next recorded frame to the scene graph. Scene patches are not cleared,
+     * so the caller is expected to run SceneGraph::UpdateTransforms(), consume the patches and clear them just like in a live frame.
+     * @returns false if all frames have been replayed already.
+     */
+    bool ReplayFrame();
+
+  private:
+    [[nodiscard]] const u8* GetRange(u64 offset, u64 size) const;
+    [[nodiscard]] SceneNode* GetNode(u64 recorded_handle) const;
+
+    void ReplayRecord(u32 type, std::span<const u8> data);
+    void ReplayNodeRemoved(u64 recorded_handle, bool hidden);
+
+    template<typename T>
+    [[nodiscard]] std::shared_ptr<T> GetResource(const std::unordered_map<u32, std::shared_ptr<T>>& resources, u32 id) const;
+
+    std::filesystem::path m_path;
+    MappedFile m_file;
+    u64 m_read_offset{};
+
+    std::shared_ptr<SceneGraph> m_scene_graph;
+    std::unordered_map<u64, SceneNode*> m_nodes{}; //< Maps the recorded node handles to the nodes in the scene graph of the player
+    std::unordered_map<const SceneNode*, u64> m_recorded_handles{};
+
+    std::unordered_map<u32, std::shared_ptr<Geometry>> m_geometries{};
+    std::unordered_map<u32, std::shared_ptr<Material>> m_materials{};
+    std::unordered_map<u32, std::shared_ptr<Texture2D>> m_textures{};
+    std::unordered_map<u32, std::shared_ptr<const Prefab>> m_prefabs{};
+};
+
+} // namespace zephyr
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <zephyr/scene/scene_node.hpp>
+#include <filesystem>
+#include <memory>
+
+namespace zephyr {
+
+/**
+ * Write a binary snapshot of a subtree. The snapshot contains the hierarchy, names, visibility, static flags and transforms of all nodes,
+ * as well as their meshes including the geometry, material and texture payloads. Resources shared by multiple meshes are stored only once.
+ * Records are stored in the native byte order and layout, so snapshots are a fast cache for one platform, not an interchange format.
+ */
+void SaveSceneSnapshot(const SceneNode* root, const std::filesystem::path& path);
+
+/**
+ * Load a snapshot written by SaveSceneSnapshot(). The file is memory-mapped and its fixed-size records are read in place,
+ * so that loading boils down to constructing the nodes and copying the payloads into their resources.
+ * @returns the root of a detached subtree, which can be mounted to a scene graph in one go.
+ */
+std::shared_ptr<SceneNode> LoadSceneSnapshot(const std::filesystem::path& path);
+
+} // namespace zephyr
@@ -21,8 +21,9 @@ void OpenGLRenderBackend::InitializeContext() {
   CreateDrawShaderProgram();
   CreateDrawListBuilderShaderProgram();
 
-  glCreateBuffers(1u, &m_gl_render_bundle_ssbo);
-  glNamedBufferStorage(m_gl_render_bundle_ssbo, sizeof(RenderBundleItem) * k_max_draws_per_draw_call, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  m_draw_list_buffer_capacity = k_max_draws_per_draw_call;
+  glCreateBuffers(1u, &m_gl_draw_list_ssbo);
+  glNamedBufferStorage(m_gl_draw_list_ssbo, (GLsizeiptr)(sizeof(u32) * m_draw_list_buffer_capacity), nullptr, GL_DYNAMIC_STORAGE_BIT);
 
   glCreateBuffers(1u, &m_gl_draw_list_command_ssbo);
   glNamedBufferStorage(m_gl_draw_list_command_ssbo, 6u * sizeof(u32) * k_max_draws_per_draw_call, nullptr, 0);
@@ -30,8 +31,8 @@ void OpenGLRenderBackend::InitializeContext() {
   glCreateBuffers(1u, &m_gl_camera_ubo);
   glNamedBufferStorage(m_gl_camera_ubo, sizeof(RenderCamera), nullptr, GL_DYNAMIC_STORAGE_BIT);
 
-  glCreateBuffers(1u, &m_gl_draw_count_ubo);
-  glNamedBufferStorage(m_gl_draw_count_ubo, sizeof(u32), nullptr, GL_DYNAMIC_STORAGE_BIT);
+  glCreateBuffers(1u, &m_gl_draw_parameters_ubo);
+  glNamedBufferStorage(m_gl_draw_parameters_ubo, 4u * sizeof(u32), nullptr, GL_DYNAMIC_STORAGE_BIT);
 
   glCreateBuffers(1u, &m_gl_draw_count_out_ac);
   glNamedBufferStorage(m_gl_draw_count_out_ac, sizeof(GLuint), nullptr, 0);
@@ -56,12 +57,19 @@ void OpenGLRenderBackend::DestroyContext() {
   m_render_geometry_manager.reset();
   m_render_texture_manager.reset();
 
+  for(auto& [key, static_render_bundle_buffer] : m_static_render_bundle_buffers) {
+    glDeleteBuffers(1u, &static_render_bundle_buffer.gl_ssbo);
+  }
+  m_static_render_bundle_buffers.clear();
+  glDeleteBuffers(1u, &m_render_bundle_buffer.gl_ssbo);
+  m_render_bundle_buffer = {};
+
   glDeleteBuffers(1u, &m_gl_material_data_buffer);
   glDeleteBuffers(1u, &m_gl_draw_count_out_ac);
-  glDeleteBuffers(1u, &m_gl_draw_count_ubo);
+  glDeleteBuffers(1u, &m_gl_draw_parameters_ubo);
   glDeleteBuffers(1u, &m_gl_camera_ubo);
   glDeleteBuffers(1u, &m_gl_draw_list_command_ssbo);
-  glDeleteBuffers(1u, &m_gl_render_bundle_ssbo);
+  glDeleteBuffers(1u, &m_gl_draw_list_ssbo);
   glDeleteProgram(m_gl_draw_list_builder_program);
   glDeleteProgram(m_gl_draw_program);
 
@@ -100,71 +108,157 @@ void OpenGLRenderBackend::DestroyRenderTexture(RenderTexture* render_texture) {
    m_render_texture_manager->DestroyRenderTexture(render_texture);
 }
 
-void OpenGLRenderBackend::Render(const RenderCamera& render_camera, const eastl::hash_map<RenderBundleKey, std::vector<RenderBundleItem>>& render_bundles) {
+void OpenGLRenderBackend::Render(
+  const RenderCamera& render_camera,
+  const ResidentRenderBundle& render_bundle,
+  const DrawList& draw_list,
+  const eastl::hash_map<RenderBundleKey, ResidentRenderBundle>& static_render_bundles
+) {
   glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   glNamedBufferSubData(m_gl_camera_ubo, 0, sizeof(RenderCamera), &render_camera);
 
+  // Render bundles stay resident in GPU memory, only the items which have been modified since the last frame are uploaded again.
+  const GLuint gl_render_bundle_ssbo = UpdateRenderBundleBuffer(m_render_bundle_buffer, render_bundle);
+  UpdateDrawListBuffer(draw_list);
+
   glBindBufferBase(GL_UNIFORM_BUFFER, 0u, m_gl_camera_ubo);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0u, m_gl_render_bundle_ssbo);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1u, m_gl_draw_list_command_ssbo);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3u, m_gl_draw_list_ssbo);
 
-  for(const auto& [key, render_bundle] : render_bundles) {
-    const size_t render_bundle_size = render_bundle.size();
-
-    for(size_t base_draw = 0u; base_draw < render_bundle_size; base_draw += k_max_draws_per_draw_call) {
-      const u32 number_of_draws = std::min<size_t>(render_bundle_size - base_draw, k_max_draws_per_draw_call);
-
-      // TODO(fleroviux): use persistently mapped buffers (PMBs) for this and see if they are faster?
-      // 1. Upload render bundle items into the render bundle buffer
-      glNamedBufferSubData(m_gl_render_bundle_ssbo, 0u, (GLsizeiptr)(number_of_draws * sizeof(RenderBundleItem)), &render_bundle[base_draw]);
-      glNamedBufferSubData(m_gl_draw_count_ubo, 0u, sizeof(u32), &number_of_draws);
-
-      // 2. Generate multi-draw indirect command buffer from the render bundle buffer and geometry descriptor buffer
-      {
-        glUseProgram(m_gl_draw_list_builder_program);
-
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, m_render_geometry_manager->GetGeometryRenderDataBuffer());
-        glBindBufferBase(GL_UNIFORM_BUFFER, 1u, m_gl_draw_count_ubo);
-        glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0u, m_gl_draw_count_out_ac);
-
-        const GLuint workgroup_size = 32u;
-        const GLuint workgroup_group_count = (number_of_draws + workgroup_size - 1u) / workgroup_size;
-        glDispatchCompute(workgroup_group_count, 1u, 1u);
-
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, 0u);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 1u, 0u);
-        glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0u, 0u);
-      }
-
-      // 3. Draw everything written to the Draw List SSBO
-      {
-        glUseProgram(m_gl_draw_program);
-
-        glBindVertexArray(m_render_geometry_manager->GetVAOFromLayout(RenderGeometryLayout{key.geometry_layout}));
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_gl_draw_list_command_ssbo);
-        glBindBuffer(GL_PARAMETER_BUFFER, m_gl_draw_count_out_ac);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, m_gl_material_data_buffer);
-
-        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
-        if(key.uses_ibo) {
-          glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0u, (GLsizei)number_of_draws, 6u * sizeof(u32));
-        } else {
-          glMultiDrawArraysIndirectCount(GL_TRIANGLES, nullptr, 0u, (GLsizei)number_of_draws, 6u * sizeof(u32));
-        }
-
-        glBindVertexArray(0u);
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0u);
-        glBindBuffer(GL_PARAMETER_BUFFER, 0u);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, 0u);
-      }
+  // The draw list is sorted, so each range is drawn with a single VAO and the items are submitted roughly front-to-back.
+  // Note that GPU culling compacts the draws of a range with an atomic counter, which does not strictly retain their order.
+  for(const DrawList::Range& range : draw_list.ranges) {
+    for(u32 base_draw = 0u; base_draw < range.number_of_items; base_draw += k_max_draws_per_draw_call) {
+      const u32 number_of_draws = std::min<u32>(range.number_of_items - base_draw, k_max_draws_per_draw_call);
+
+      DrawRenderBundleItems(range.key, gl_render_bundle_ssbo, range.first_item + base_draw, number_of_draws, true);
+    }
+  }
+
+  for(const auto& [key, static_render_bundle] : static_render_bundles) {
+    const GLuint gl_static_render_bundle_ssbo = UpdateRenderBundleBuffer(m_static_render_bundle_buffers[key], static_render_bundle);
+    const u32 render_bundle_size = (u32)static_render_bundle.items.size();
+
+    for(u32 base_draw = 0u; base_draw < render_bundle_size; base_draw += k_max_draws_per_draw_call) {
+      const u32 number_of_draws = std::min<u32>(render_bundle_size - base_draw, k_max_draws_per_draw_call);
+
+      DrawRenderBundleItems(key, gl_static_render_bundle_ssbo, base_draw, number_of_draws, false);
     }
   }
 
   glBindBufferBase(GL_UNIFORM_BUFFER, 0u, 0u);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0u, 0u);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1u, 0u);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3u, 0u);
+}
+
+void OpenGLRenderBackend::DrawRenderBundleItems(const RenderBundleKey& key, GLuint gl_render_bundle_ssbo, u32 first_item, u32 number_of_draws, bool use_draw_list) {
+  // Must match the DrawParameters uniform block of the draw list builder.
+  const u32 draw_parameters[4] {number_of_draws, first_item, use_draw_list ? 1u : 0u, 0u};
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0u, gl_render_bundle_ssbo);
+  glNamedBufferSubData(m_gl_draw_parameters_ubo, 0u, sizeof(draw_parameters), draw_parameters);
+
+  // 1. Generate multi-draw indirect command buffer from the render bundle buffer and geometry descriptor buffer
+  {
+    glUseProgram(m_gl_draw_list_builder_program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, m_render_geometry_manager->GetGeometryRenderDataBuffer());
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1u, m_gl_draw_parameters_ubo);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0u, m_gl_draw_count_out_ac);
+
+    const GLuint workgroup_size = 32u;
+    const GLuint workgroup_group_count = (number_of_draws + workgroup_size - 1u) / workgroup_size;
+    glDispatchCompute(workgroup_group_count, 1u, 1u);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, 0u);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1u, 0u);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0u, 0u);
+  }
+
+  // 2. Draw everything written to the Draw List SSBO
+  {
+    glUseProgram(m_gl_draw_program);
+
+    glBindVertexArray(m_render_geometry_manager->GetVAOFromLayout(RenderGeometryLayout{key.geometry_layout}));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_gl_draw_list_command_ssbo);
+    glBindBuffer(GL_PARAMETER_BUFFER, m_gl_draw_count_out_ac);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, m_gl_material_data_buffer);
+
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    if(key.uses_ibo) {
+      glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0u, (GLsizei)number_of_draws, 6u * sizeof(u32));
+    } else {
+      glMultiDrawArraysIndirectCount(GL_TRIANGLES, nullptr, 0u, (GLsizei)number_of_draws, 6u * sizeof(u32));
+    }
+
+    glBindVertexArray(0u);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0u);
+    glBindBuffer(GL_PARAMETER_BUFFER, 0u);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, 0u);
+  }
+}
+
+GLuint OpenGLRenderBackend::UpdateRenderBundleBuffer(RenderBundleBuffer& buffer, const ResidentRenderBundle& render_bundle) {
+  if(buffer.version == render_bundle.version) {
+    return buffer.gl_ssbo;
+  }
+
+  const size_t number_of_items = render_bundle.items.size();
+
+  // The dirty ranges only describe the changes to the previous version, so the buffer must be filled entirely if it is older.
+  bool upload_all_items = buffer.version + 1u != render_bundle.version;
+
+  if(buffer.capacity < number_of_items) {
+    // Grow geometrically, so that adding items one after another does not reallocate the buffer each time.
+    glDeleteBuffers(1u, &buffer.gl_ssbo);
+    buffer.capacity = std::max(number_of_items, buffer.capacity * 2u);
+    glCreateBuffers(1u, &buffer.gl_ssbo);
+    glNamedBufferStorage(buffer.gl_ssbo, (GLsizeiptr)(buffer.capacity * sizeof(RenderBundleItem)), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    upload_all_items = true;
+  }
+
+  // TODO(fleroviux): use persistently mapped buffers (PMBs) for this and see if they are faster?
+  if(upload_all_items) {
+    if(number_of_items > 0u) {
+      glNamedBufferSubData(buffer.gl_ssbo, 0u, (GLsizeiptr)(number_of_items * sizeof(RenderBundleItem)), render_bundle.items.data());
+    }
+  } else {
+    for(const RenderBundleItemRange& dirty_range : render_bundle.dirty_ranges) {
+      glNamedBufferSubData(
+        buffer.gl_ssbo,
+        (GLintptr)(dirty_range.first_item * sizeof(RenderBundleItem)),
+        (GLsizeiptr)(dirty_range.number_of_items * sizeof(RenderBundleItem)),
+        &render_bundle.items[dirty_range.first_item]
+      );
+    }
+  }
+
+  buffer.version = render_bundle.version;
+  return buffer.gl_ssbo;
+}
+
+void OpenGLRenderBackend::UpdateDrawListBuffer(const DrawList& draw_list) {
+  if(m_draw_list_buffer_version == draw_list.version) {
+    return;
+  }
+
+  const size_t number_of_items = draw_list.items.size();
+
+  if(m_draw_list_buffer_capacity < number_of_items) {
+    glDeleteBuffers(1u, &m_gl_draw_list_ssbo);
+    m_draw_list_buffer_capacity = std::max(number_of_items, m_draw_list_buffer_capacity * 2u);
+    glCreateBuffers(1u, &m_gl_draw_list_ssbo);
+    glNamedBufferStorage(m_gl_draw_list_ssbo, (GLsizeiptr)(m_draw_list_buffer_capacity * sizeof(u32)), nullptr, GL_DYNAMIC_STORAGE_BIT);
+  }
+
+  if(number_of_items > 0u) {
+    glNamedBufferSubData(m_gl_draw_list_ssbo, 0u, (GLsizeiptr)(number_of_items * sizeof(u32)), draw_list.items.data());
+  }
+
+  m_draw_list_buffer_version = draw_list.version;
 }
 
 void OpenGLRenderBackend::SwapBuffers() {
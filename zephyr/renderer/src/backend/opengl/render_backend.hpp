@@ -30,16 +30,31 @@ class OpenGLRenderBackend final : public RenderBackend {
     void UpdateRenderTextureData(RenderTexture* render_texture, std::span<const u8> data) override;
     void DestroyRenderTexture(RenderTexture* render_texture) override;
 
-    void Render(const RenderCamera& render_camera, const eastl::hash_map<RenderBundleKey, std::vector<RenderBundleItem>>& render_bundles) override;
+    void Render(
+      const RenderCamera& render_camera,
+      const ResidentRenderBundle& render_bundle,
+      const DrawList& draw_list,
+      const eastl::hash_map<RenderBundleKey, ResidentRenderBundle>& static_render_bundles
+    ) override;
 
     void SwapBuffers() override;
 
   private:
     static constexpr u32 k_max_draws_per_draw_call = 16384;
 
+    struct RenderBundleBuffer {
+      GLuint gl_ssbo{};
+      size_t capacity{}; //< Capacity of the buffer in render bundle items
+      u64 version{}; //< Version of the render bundle that was last uploaded to the buffer
+    };
+
     void CreateDrawShaderProgram();
     void CreateDrawListBuilderShaderProgram();
 
+    void DrawRenderBundleItems(const RenderBundleKey& key, GLuint gl_render_bundle_ssbo, u32 first_item, u32 number_of_draws, bool use_draw_list);
+    GLuint UpdateRenderBundleBuffer(RenderBundleBuffer& buffer, const ResidentRenderBundle& render_bundle);
+    void UpdateDrawListBuffer(const DrawList& draw_list);
+
     static GLuint CreateShader(const char* glsl_code, GLenum type);
     static GLuint CreateProgram(std::span<const GLuint> shaders);
 
@@ -47,14 +62,19 @@ class OpenGLRenderBackend final : public RenderBackend {
     SDL_GLContext m_gl_context{};
     GLuint m_gl_draw_program{};
     GLuint m_gl_draw_list_builder_program{};
-    GLuint m_gl_render_bundle_ssbo{};
+    GLuint m_gl_draw_list_ssbo{};
+    size_t m_draw_list_buffer_capacity{}; //< Capacity of the draw list buffer in item indices
+    u64 m_draw_list_buffer_version{}; //< Version of the draw list that was last uploaded to the draw list buffer
     GLuint m_gl_draw_list_command_ssbo{};
     GLuint m_gl_camera_ubo{};
-    GLuint m_gl_draw_count_ubo{};
+    GLuint m_gl_draw_parameters_ubo{};
     GLuint m_gl_draw_count_out_ac{};
 
     GLuint m_gl_material_data_buffer{};
 
+    RenderBundleBuffer m_render_bundle_buffer{}; //< Holds the dynamic render bundle
+    eastl::hash_map<RenderBundleKey, RenderBundleBuffer> m_static_render_bundle_buffers{};
+
     std::unique_ptr<OpenGLRenderGeometryManager> m_render_geometry_manager{};
     std::unique_ptr<OpenGLRenderTextureManager> m_render_texture_manager{};
 };
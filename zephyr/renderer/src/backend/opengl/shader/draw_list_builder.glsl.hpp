@@ -41,27 +41,35 @@ static constexpr auto k_draw_list_builder_comp_glsl = R"(
     RenderGeometryRenderData rb_render_geometry_render_data[];
   };
 
+  layout(std430, binding = 3) readonly buffer DrawListBuffer {
+    uint rb_draw_list_items[];
+  };
+
   layout(std140, binding = 0) uniform Camera {
     mat4 u_projection;
     mat4 u_view;
     vec4 u_frustum_planes[6];
   };
 
-  layout(std140, binding = 1) uniform DrawCount {
+  layout(std140, binding = 1) uniform DrawParameters {
     uint u_draw_count;
+    uint u_first_item; // The first render bundle item or, if the draw list is used, the first draw list item
+    uint u_use_draw_list; // Whether the render bundle items are referenced by the draw list or drawn in order
   };
 
   layout(binding = 0) uniform atomic_uint u_draw_count_out;
 
   void main() {
-    const uint render_bundle_item_id = gl_GlobalInvocationID.x;
+    const uint draw_id = gl_GlobalInvocationID.x;
 
-    if(render_bundle_item_id == 0u) {
+    if(draw_id == 0u) {
       atomicCounterExchange(u_draw_count_out, 0u);
     }
     barrier();
 
-    if(render_bundle_item_id < u_draw_count) {
+    if(draw_id < u_draw_count) {
+      const uint render_bundle_item_id = u_use_draw_list != 0u ? rb_draw_list_items[u_first_item + draw_id] : u_first_item + draw_id;
+
       RenderBundleItem render_bundle_item = rb_render_bundle_items[render_bundle_item_id];
       RenderGeometryRenderData render_data = rb_render_geometry_render_data[render_bundle_item.geometry_id];
 
@@ -97,8 +105,8 @@ static constexpr auto k_draw_list_builder_comp_glsl = R"(
       }
 
       if(inside_frustum) {
-        uint draw_id = atomicCounterIncrement(u_draw_count_out);
-        b_command_buffer[draw_id] = DrawCommandWithRenderBundleItemID(render_data.draw_command, render_bundle_item_id);
+        uint command_id = atomicCounterIncrement(u_draw_count_out);
+        b_command_buffer[command_id] = DrawCommandWithRenderBundleItemID(render_data.draw_command, render_bundle_item_id);
       }
     }
   }
@@ -0,0 +1,53 @@
+#include <zephyr/renderer/component/mesh.hpp>
+#include <zephyr/renderer/prefab.hpp>
+#include <zephyr/scene/scene_node.hpp>
+
+namespace zephyr {
+
+Prefab::Prefab(std::vector<Mesh> meshes) : m_meshes{std::move(meshes)} {
+  for(const Mesh& mesh : m_meshes) {
+    if(mesh.geometry) {
+      m_bounds = m_bounds.Union(mesh.geometry->GetAABB().ApplyMatrix(mesh.local_to_prefab));
+    }
+  }
+}
+
+std::shared_ptr<const Prefab> Prefab::FromSubtree(const SceneNode* root) {
+  std::vector<Mesh> meshes{};
+
+  // Imported hierarchies may be arbitrarily deep, so walk them iteratively like SceneNode::Traverse() instead of recursing.
+  struct StackEntry {
+    const SceneNode* node;
+    Matrix4 local_to_prefab;
+  };
+
+  std::vector<StackEntry> stack{};
+  stack.push_back({root, Matrix4::Identity()});
+
+  while(!stack.empty()) {
+    const StackEntry entry = stack.back();
+    stack.pop_back();
+
+    if(entry.node->HasComponent<MeshComponent>()) {
+      const MeshComponent& mesh_component = entry.node->GetComponent<MeshComponent>();
+      meshes.push_back({mesh_component.geometry, mesh_component.material, entry.local_to_prefab});
+    }
+
+    // Push children in reverse, so that the meshes are listed in traversal order.
+    const auto children = entry.node->GetChildren();
+
+    for(auto it = children.rbegin(); it != children.rend(); ++it) {
+      const SceneNode* child_node = it->get();
+
+      if(child_node->IsVisible()) {
+        const Transform3D& child_transform = child_node->GetTransform();
+        const Matrix4 child_local = Transform3D::ComposeLocal(child_transform.GetPosition(), child_transform.GetRotation(), child_transform.GetScale());
+        stack.push_back({child_node, entry.local_to_prefab * child_local});
+      }
+    }
+  }
+
+  return std::make_shared<const Prefab>(std::move(meshes));
+}
+
+} // namespace zephyr
@@ -1,11 +1,13 @@
 
 #include <zephyr/renderer/render_engine.hpp>
+#include <algorithm>
 
 namespace zephyr {
 
 RenderEngine::RenderEngine(std::unique_ptr<RenderBackend> render_backend)
     : m_render_backend{std::move(render_backend)}
-    , m_render_scene{m_render_backend} {
+    , m_render_scene{m_render_backend}
+    , m_render_thread_pool{std::max(std::thread::hardware_concurrency() / 2u, 1u)} {
   CreateRenderThread();
 }
 
@@ -49,7 +51,7 @@ void RenderEngine::RenderThreadMain() {
     ReadyRenderThreadData();
 
     // m_render_backend->Render(m_render_camera, m_render_objects);
-    m_render_backend->Render(m_render_camera, m_render_scene.GetRenderBundles());
+    m_render_backend->Render(m_render_camera, m_render_scene.GetDynamicRenderBundle(), m_render_scene.GetDrawList(), m_render_scene.GetStaticRenderBundles());
     m_render_backend->SwapBuffers();
   }
 
@@ -63,7 +65,7 @@ void RenderEngine::ReadyRenderThreadData() {
   m_render_thread_is_waiting = false;
 
   // Update the GPU scene based on changes in the scene graph (stage 2)
-  m_render_scene.UpdateStage2();
+  m_render_scene.UpdateStage2(m_render_thread_pool);
 
   m_render_scene.GetRenderCamera(m_render_camera);
 
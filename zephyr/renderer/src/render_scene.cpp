@@ -1,9 +1,12 @@
 
 #include <zephyr/renderer/component/camera.hpp>
 #include <zephyr/renderer/component/mesh.hpp>
+#include <zephyr/renderer/component/prefab_instance.hpp>
 #include <zephyr/renderer/render_scene.hpp>
 #include <zephyr/scene/scene_node.hpp>
+#include <zephyr/radix_sort.hpp>
 #include <algorithm>
+#include <bit>
 
 namespace zephyr {
 
@@ -21,6 +24,9 @@ void RenderScene::SetSceneGraph(std::shared_ptr<SceneGraph> scene_graph) {
 }
 
 void RenderScene::UpdateStage1() {
+  // The snapshot stays valid until after the next frame's transform update, so the render thread can read it in stage 2.
+  m_world_matrices = m_current_scene_graph->GetWorldMatrixSnapshot();
+
   if(m_require_full_rebuild) {
     RebuildScene();
     m_require_full_rebuild = false;
@@ -28,6 +34,8 @@ void RenderScene::UpdateStage1() {
     PatchScene();
   }
 
+  CullScene();
+
   // Temporary: test creating a texture and uploading some data to it
   if(!m_test_texture) {
     m_test_texture = std::make_unique<Texture2D>(64, 64);
@@ -52,135 +60,326 @@ void RenderScene::UpdateStage1() {
 
 void RenderScene::GetRenderCamera(RenderCamera& out_render_camera) {
   // TODO(fleroviux): implement a better way to pick the camera to use.
-  if(m_view_camera.empty()) {
+  if(m_view_camera.IsEmpty()) {
     ZEPHYR_PANIC("Scene graph does not contain a camera to render with.");
   }
 
   const EntityID entity_id = m_view_camera[0];
-  const Transform& entity_transform = m_components_transform[entity_id];
   const Camera& entity_camera = m_components_camera[entity_id];
   out_render_camera.projection = entity_camera.projection;
   out_render_camera.frustum = entity_camera.frustum;
-  out_render_camera.view = entity_transform.local_to_world.Inverse();
+  out_render_camera.view = GetEntityWorldMatrix(entity_id).Inverse();
 }
 
-[[nodiscard]] const eastl::hash_map<RenderBackend::RenderBundleKey, std::vector<RenderBackend::RenderBundleItem>>& RenderScene::GetRenderBundles() {
-  return m_render_bundles;
+[[nodiscard]] const RenderBackend::ResidentRenderBundle& RenderScene::GetDynamicRenderBundle() {
+  return m_render_bundle;
+}
+
+[[nodiscard]] const RenderBackend::DrawList& RenderScene::GetDrawList() {
+  return m_draw_list;
+}
+
+[[nodiscard]] const eastl::hash_map<RenderBackend::RenderBundleKey, RenderBackend::ResidentRenderBundle>& RenderScene::GetStaticRenderBundles() {
+  return m_static_render_bundles;
 }
 
 void RenderScene::UpdateStage2() {
   m_geometry_cache.ProcessQueuedTasks();
   m_texture_cache.ProcessQueuedTasks();
 
+  ClearDirtyRanges();
+
   for(const RenderScenePatch& render_scene_patch : m_render_scene_patches) {
-    switch(render_scene_patch.type) {
-      case RenderScenePatch::Type::MeshMounted: {
-        const EntityID entity_id = render_scene_patch.entity_id;
-        const Transform& entity_transform = m_components_transform[entity_id];
-        const Mesh& entity_mesh = m_components_mesh[render_scene_patch.entity_id];
-
-        // TODO(fleroviux): get rid of unsafe size_t to u32 conversion.
-        const RenderGeometry* const render_geometry = m_geometry_cache.GetCachedRenderGeometry(entity_mesh.geometry);
-        RenderBackend::RenderBundleKey render_bundle_key{};
-        render_bundle_key.uses_ibo = render_geometry->GetNumberOfIndices();
-        render_bundle_key.geometry_layout = render_geometry->GetLayout().key;
-
-        std::vector<RenderBackend::RenderBundleItem>& render_bundle = m_render_bundles[render_bundle_key];
-        render_bundle.emplace_back(entity_transform.local_to_world, (u32)render_geometry->GetGeometryID(), (u32)0u, entity_id);
-
-        m_entity_to_render_item_location[entity_id] = { render_bundle_key, render_bundle.size() - 1u };
-        break;
+    ApplyRenderScenePatch(render_scene_patch);
+  }
+
+  m_render_scene_patches.clear();
+
+  CoalesceDirtyRanges();
+  BuildDrawList();
+}
+
+void RenderScene::UpdateStage2(ThreadPool& thread_pool) {
+  m_geometry_cache.ProcessQueuedTasks();
+  m_texture_cache.ProcessQueuedTasks();
+
+  ClearDirtyRanges();
+
+  /**
+   * Mount and remove patches move items between and within render bundles, so they are applied in order first.
+   * A transform change only depends on the final location of an item and on the world matrix snapshot, so the transform changes
+   * can be applied afterwards in any order. Each entity receives at most one transform change per frame, thus they write disjoint items.
+   */
+  std::vector<EntityID>& transform_patches = m_transform_patches;
+  transform_patches.clear();
+
+  for(const RenderScenePatch& render_scene_patch : m_render_scene_patches) {
+    if(render_scene_patch.type == RenderScenePatch::Type::TransformChanged) {
+      transform_patches.push_back(render_scene_patch.entity_id);
+    } else {
+      ApplyRenderScenePatch(render_scene_patch);
+    }
+  }
+
+  m_render_scene_patches.clear();
+
+  const size_t number_of_threads = thread_pool.GetNumberOfThreads();
+  const size_t number_of_batches = std::min(number_of_threads * k_transform_patch_batches_per_thread, transform_patches.size() / k_min_transform_patches_per_batch);
+
+  if(number_of_batches <= 1u) {
+    for(const EntityID entity_id : transform_patches) {
+      ApplyTransformChanged(entity_id);
+    }
+  } else {
+    // Marking items dirty appends to the dirty ranges of their render bundles, which is left to the calling thread to avoid racing on them.
+    m_thread_local_dirty_items.resize(number_of_threads);
+
+    thread_pool.ParallelFor(number_of_batches, [&](size_t batch_index, size_t thread_index) {
+      std::vector<EntityID>& dirty_items = m_thread_local_dirty_items[thread_index];
+
+      const size_t first_patch = transform_patches.size() * batch_index / number_of_batches;
+      const size_t last_patch  = transform_patches.size() * (batch_index + 1u) / number_of_batches;
+
+      for(size_t patch = first_patch; patch < last_patch; patch++) {
+        const EntityID entity_id = transform_patches[patch];
+        const RenderBundleItemLocation& location = m_components_render_item_location[entity_id];
+
+        if(location.render_bundle) {
+          location.render_bundle->items[location.index].local_to_world = GetEntityWorldMatrix(entity_id);
+          dirty_items.push_back(entity_id);
+        }
+      }
+    });
+
+    for(std::vector<EntityID>& dirty_items : m_thread_local_dirty_items) {
+      for(const EntityID entity_id : dirty_items) {
+        const RenderBundleItemLocation& location = m_components_render_item_location[entity_id];
+        MarkRenderBundleItemDirty(*location.render_bundle, location.index);
       }
-      case RenderScenePatch::Type::MeshRemoved: {
-        const auto match = m_entity_to_render_item_location.find(render_scene_patch.entity_id);
-        const RenderBundleItemLocation& location = match->second;
+      dirty_items.clear();
+    }
+  }
 
-        std::vector<RenderBackend::RenderBundleItem>& render_bundle = m_render_bundles[location.key];
-        render_bundle[location.index] = render_bundle.back();
-        m_entity_to_render_item_location[render_bundle.back().entity_id].index = location.index;
-        render_bundle.pop_back();
+  CoalesceDirtyRanges();
+  BuildDrawList();
+}
+
+void RenderScene::ApplyRenderScenePatch(const RenderScenePatch& render_scene_patch) {
+  switch(render_scene_patch.type) {
+    case RenderScenePatch::Type::MeshMounted: {
+      const EntityID entity_id = render_scene_patch.entity_id;
+      const Mesh& entity_mesh = m_components_mesh[render_scene_patch.entity_id];
+
+      // TODO(fleroviux): get rid of unsafe size_t to u32 conversion.
+      const RenderGeometry* const render_geometry = m_geometry_cache.GetCachedRenderGeometry(entity_mesh.geometry);
+      RenderBackend::RenderBundleKey render_bundle_key{};
+      render_bundle_key.uses_ibo = render_geometry->GetNumberOfIndices();
+      render_bundle_key.geometry_layout = render_geometry->GetLayout().key;
+
+      // Resolve the render bundle once, all later patches of the item go straight to the bundle.
+      RenderBundleItemLocation& location = m_components_render_item_location[entity_id];
+
+      if(entity_mesh.is_static) {
+        location.render_bundle = &m_static_render_bundles[render_bundle_key];
+      } else {
+        // Dynamic items of all render bundles share one render bundle, the draw list groups them by render bundle key each frame.
+        location.render_bundle = &m_render_bundle;
+      }
+
+      const u32 material_id = 0u;
+
+      std::vector<RenderBackend::RenderBundleItem>& items = location.render_bundle->items;
+      items.emplace_back(GetEntityWorldMatrix(entity_id), (u32)render_geometry->GetGeometryID(), material_id, entity_id);
+      location.index = (u32)items.size() - 1u;
+      location.sort_key = GetSortKey(render_bundle_key, material_id);
+      MarkRenderBundleItemDirty(*location.render_bundle, location.index);
+      break;
+    }
+    case RenderScenePatch::Type::MeshRemoved: {
+      RenderBundleItemLocation& location = m_components_render_item_location[render_scene_patch.entity_id];
 
-        m_entity_to_render_item_location.erase(match);
+      std::vector<RenderBackend::RenderBundleItem>& items = location.render_bundle->items;
+      items[location.index] = items.back();
+      m_components_render_item_location[items.back().entity_id].index = location.index;
+      items.pop_back();
+
+      // Unless the removed item was the last one, the last item has been moved into its place.
+      if(location.index < items.size()) {
+        MarkRenderBundleItemDirty(*location.render_bundle, location.index);
+      }
+
+      location = {};
+      break;
+    }
+    case RenderScenePatch::Type::TransformChanged: {
+      ApplyTransformChanged(render_scene_patch.entity_id);
+      break;
+    }
+    default: ZEPHYR_PANIC("unhandled patch type: {}", (int)render_scene_patch.type);
+  }
+}
+
+void RenderScene::ApplyTransformChanged(EntityID entity_id) {
+  const RenderBundleItemLocation& location = m_components_render_item_location[entity_id];
+
+  if(location.render_bundle) {
+    // Static items only receive transform changes when an ancestor of a static node has moved.
+    location.render_bundle->items[location.index].local_to_world = GetEntityWorldMatrix(entity_id);
+    MarkRenderBundleItemDirty(*location.render_bundle, location.index);
+  }
+}
+
+void RenderScene::MarkRenderBundleItemDirty(RenderBackend::ResidentRenderBundle& render_bundle, u32 index) {
+  std::vector<RenderBackend::RenderBundleItemRange>& dirty_ranges = render_bundle.dirty_ranges;
+
+  if(dirty_ranges.empty()) {
+    m_dirty_render_bundles.push_back(&render_bundle);
+  } else {
+    // Items are often marked in ascending order, i.e. when many nodes are mounted at once, so try to extend the last range first.
+    RenderBackend::RenderBundleItemRange& last_range = dirty_ranges.back();
+
+    if(index >= last_range.first_item && index <= last_range.first_item + last_range.number_of_items) {
+      last_range.number_of_items = std::max(last_range.number_of_items, index - last_range.first_item + 1u);
+      return;
+    }
+  }
+
+  dirty_ranges.push_back({.first_item = index, .number_of_items = 1u});
+}
+
+void RenderScene::ClearDirtyRanges() {
+  // The backend has uploaded the dirty ranges of the previous frame by now.
+  for(RenderBackend::ResidentRenderBundle* render_bundle : m_dirty_render_bundles) {
+    render_bundle->dirty_ranges.clear();
+  }
+  m_dirty_render_bundles.clear();
+}
+
+void RenderScene::CoalesceDirtyRanges() {
+  for(RenderBackend::ResidentRenderBundle* render_bundle : m_dirty_render_bundles) {
+    std::vector<RenderBackend::RenderBundleItemRange>& dirty_ranges = render_bundle->dirty_ranges;
+    const u32 number_of_items = (u32)render_bundle->items.size();
+
+    RadixSort(dirty_ranges, m_dirty_range_sort_scratch, [](const RenderBackend::RenderBundleItemRange& range) { return (u64)range.first_item; });
+
+    // Merge overlapping and nearby ranges and drop the parts of ranges beyond the items which have been removed in the meantime.
+    size_t number_of_merged_ranges = 0u;
+
+    for(const RenderBackend::RenderBundleItemRange& range : dirty_ranges) {
+      if(range.first_item >= number_of_items) {
         break;
       }
-      case RenderScenePatch::Type::TransformChanged: {
-        const auto match = m_entity_to_render_item_location.find(render_scene_patch.entity_id);
 
-        if(match != m_entity_to_render_item_location.end()) {
-          const RenderBundleItemLocation& location = match->second;
+      const u32 end_item = std::min(range.first_item + range.number_of_items, number_of_items);
+
+      if(number_of_merged_ranges > 0u) {
+        RenderBackend::RenderBundleItemRange& last_range = dirty_ranges[number_of_merged_ranges - 1u];
+        const u32 last_end_item = last_range.first_item + last_range.number_of_items;
 
-          m_render_bundles[location.key][location.index].local_to_world = m_components_transform[render_scene_patch.entity_id].local_to_world;
+        if(range.first_item <= last_end_item + k_max_dirty_range_gap) {
+          last_range.number_of_items = std::max(last_end_item, end_item) - last_range.first_item;
+          continue;
         }
-        break;
       }
-      default: ZEPHYR_PANIC("unhandled patch type: {}", (int)render_scene_patch.type);
+
+      dirty_ranges[number_of_merged_ranges++] = {.first_item = range.first_item, .number_of_items = end_item - range.first_item};
     }
-  }
 
-  m_render_scene_patches.clear();
+    dirty_ranges.resize(number_of_merged_ranges);
+    render_bundle->version++;
+  }
 }
 
 void RenderScene::RebuildScene() {
-  m_node_entity_map.clear();
+  m_node_entity_table.clear();
   m_entities.clear();
+  m_view_mesh.Clear();
+  m_view_camera.Clear();
   ResizeComponentStorage(0);
 
-  m_current_scene_graph->GetRoot()->Traverse([this](SceneNode* child_node) {
-    if(child_node->IsVisible()) {
-      PatchNodeMounted(child_node);
-      return true;
+  // Consume the component pools directly instead of traversing the scene graph. The pools are shared by all nodes,
+  // so nodes which belong to a different scene graph or are not visible in the world have to be skipped.
+  const SceneGraph* scene_graph = m_current_scene_graph.get();
+
+  const auto is_node_in_scene = [&](const SceneNode* node) {
+    return node->GetSceneGraph() == scene_graph && scene_graph->QueryNodeWorldVisibility(node);
+  };
+
+  // A node may be found in multiple pools, but it must be mounted only once, so that it receives only one transform change.
+  const auto rebuild_node = [&](SceneNode* node) {
+    if(is_node_in_scene(node) && GetEntityForNode(node->GetHandle().index) == k_no_entity) {
+      PatchNodeMounted(node);
     }
-    return false;
-  });
+  };
+
+  for(SceneNode* node : ComponentPool<MeshComponent>::Get().GetNodes()) {
+    rebuild_node(node);
+  }
+
+  for(SceneNode* node : ComponentPool<PerspectiveCameraComponent>::Get().GetNodes()) {
+    rebuild_node(node);
+  }
+
+  for(SceneNode* node : ComponentPool<PrefabInstanceComponent>::Get().GetNodes()) {
+    rebuild_node(node);
+  }
 }
 
 void RenderScene::PatchScene() {
+  const SceneGraph& scene_graph = *m_current_scene_graph;
+
+  // The handles of removed nodes are stale, all other patches reference nodes which are still mounted.
   for(const ScenePatch& patch : m_current_scene_graph->GetScenePatches()) {
     switch(patch.type) {
-      case ScenePatch::Type::NodeMounted: PatchNodeMounted(patch.node.get()); break;
-      case ScenePatch::Type::NodeRemoved: PatchNodeRemoved(patch.node.get()); break;
-      case ScenePatch::Type::ComponentMounted: PatchNodeComponentMounted(patch.node.get(), patch.component_type); break;
-      case ScenePatch::Type::ComponentRemoved: PatchNodeComponentRemoved(patch.node.get(), patch.component_type); break;
-      case ScenePatch::Type::NodeTransformChanged: PatchNodeTransformChanged(patch.node.get()); break;
+      case ScenePatch::Type::NodeMounted: PatchNodeMounted(scene_graph.GetNode(patch.node)); break;
+      case ScenePatch::Type::NodeRemoved: PatchNodeRemoved(patch.node); break;
+      case ScenePatch::Type::ComponentMounted: PatchNodeComponentMounted(scene_graph.GetNode(patch.node), patch.component_type); break;
+      case ScenePatch::Type::ComponentRemoved: PatchNodeComponentRemoved(patch.node, patch.component_type); break;
+      case ScenePatch::Type::NodeTransformChanged: PatchNodeTransformChanged(scene_graph.GetNode(patch.node)); break;
       default: ZEPHYR_PANIC("Unhandled scene patch type: {}", (int)patch.type);
     }
   }
 }
 
 void RenderScene::PatchNodeMounted(SceneNode* node) {
-  for(auto& [component_type, _] : node->GetComponents()) {
-    PatchNodeComponentMounted(node, component_type);
+  for(u64 component_mask = node->GetComponentMask(); component_mask != 0u; component_mask &= component_mask - 1u) {
+    PatchNodeComponentMounted(node, (ComponentTypeID)std::countr_zero(component_mask));
   }
 
   PatchNodeTransformChanged(node);
 }
 
-void RenderScene::PatchNodeRemoved(SceneNode* node) {
-  for(auto& [component_type, _] : node->GetComponents()) {
-    PatchNodeComponentRemoved(node, component_type);
+void RenderScene::PatchNodeRemoved(SceneNodeHandle node_handle) {
+  const EntityID entity_id = GetEntityForNode(node_handle.index);
+  if(entity_id == k_no_entity) {
+    return;
+  }
+
+  // The node is gone already, so the entity itself has to tell which components were mounted.
+  const Entity entity = m_entities[entity_id];
+
+  if(entity & COMPONENT_FLAG_MESH) {
+    PatchNodeComponentRemoved(node_handle, ComponentRegistry::GetTypeID<MeshComponent>());
+  }
+
+  if(entity & COMPONENT_FLAG_CAMERA) {
+    PatchNodeComponentRemoved(node_handle, ComponentRegistry::GetTypeID<PerspectiveCameraComponent>());
+  }
+
+  if(entity & COMPONENT_FLAG_PREFAB_INSTANCE) {
+    PatchNodeComponentRemoved(node_handle, ComponentRegistry::GetTypeID<PrefabInstanceComponent>());
   }
 }
 
-void RenderScene::PatchNodeComponentMounted(SceneNode* node, std::type_index component_type) {
-  if(component_type == typeid(MeshComponent)) {
+void RenderScene::PatchNodeComponentMounted(SceneNode* node, ComponentTypeID component_type) {
+  if(component_type == ComponentRegistry::GetTypeID<MeshComponent>()) {
     const MeshComponent& node_mesh_component = node->GetComponent<MeshComponent>();
 
     const EntityID entity_id = GetOrCreateEntityForNode(node);
-    Mesh& entity_mesh = m_components_mesh[entity_id];
-    entity_mesh.geometry = node_mesh_component.geometry.get();
-    entity_mesh.material = node_mesh_component.material.get();
-    if(entity_mesh.material == nullptr) [[unlikely]] {
-      // TODO(fleroviux): this should ideally never happen, but what would be the best way to safeguard against it?
-      entity_mesh.material = &m_material_placeholder;
-    }
-    m_entities[entity_id] |= COMPONENT_FLAG_MESH;
-    m_view_mesh.push_back(entity_id);
-    m_geometry_cache.IncrementGeometryRefCount(entity_mesh.geometry);
-    m_material_cache.IncrementMaterialRefCount(entity_mesh.material);
-    m_render_scene_patches.push_back({.type = RenderScenePatch::Type::MeshMounted, .entity_id = entity_id});
+    AddMeshToEntity(entity_id, node_mesh_component.geometry.get(), node_mesh_component.material.get(), node->IsStatic());
   }
 
-  if(component_type == typeid(PerspectiveCameraComponent)) {
+  if(component_type == ComponentRegistry::GetTypeID<PerspectiveCameraComponent>()) {
     const PerspectiveCameraComponent& node_camera_component = node->GetComponent<PerspectiveCameraComponent>();
 
     const EntityID entity_id = GetOrCreateEntityForNode(node);
@@ -188,62 +387,254 @@ void RenderScene::PatchNodeComponentMounted(SceneNode* node, std::type_index com
     entity_camera.projection = node_camera_component.GetProjectionMatrix();
     entity_camera.frustum = node_camera_component.GetFrustum();
     m_entities[entity_id] |= COMPONENT_FLAG_CAMERA;
-    m_view_camera.push_back(entity_id);
+    m_view_camera.Insert(entity_id);
+  }
+
+  if(component_type == ComponentRegistry::GetTypeID<PrefabInstanceComponent>()) {
+    const Prefab* prefab = node->GetComponent<PrefabInstanceComponent>().prefab.get();
+
+    // Expand the instance into one entity per mesh of the prefab. These entities share the geometries and materials of the prefab
+    // and only differ from other instances in their transforms, which are derived from the transform of the instance node.
+    const EntityID entity_id = GetOrCreateEntityForNode(node);
+    m_components_prefab_instance[entity_id].prefab = prefab;
+    m_components_prefab_instance[entity_id].mesh_entities.clear();
+    m_entities[entity_id] |= COMPONENT_FLAG_PREFAB_INSTANCE;
+
+    if(prefab) {
+      for(const Prefab::Mesh& prefab_mesh : prefab->GetMeshes()) {
+        // Creating an entity may grow the component storage, so the instance must not be referenced across this call.
+        const EntityID mesh_entity_id = CreateEntity();
+        m_components_transform[mesh_entity_id] = {.world_matrix_index = node->GetHandle().index, .is_prefab_mesh = true, .local_to_prefab = prefab_mesh.local_to_prefab};
+        AddMeshToEntity(mesh_entity_id, prefab_mesh.geometry.get(), prefab_mesh.material.get(), node->IsStatic());
+        m_components_prefab_instance[entity_id].mesh_entities.push_back(mesh_entity_id);
+      }
+    }
   }
 }
 
-void RenderScene::PatchNodeComponentRemoved(SceneNode* node, std::type_index component_type) {
+void RenderScene::PatchNodeComponentRemoved(SceneNodeHandle node_handle, ComponentTypeID component_type) {
+  const EntityID entity_id = GetEntityForNode(node_handle.index);
+  if(entity_id == k_no_entity) {
+    return;
+  }
+
   bool did_remove_component = false;
 
-  if(component_type == typeid(MeshComponent)) {
-    const EntityID entity_id = GetOrCreateEntityForNode(node);
-    m_entities[entity_id] &= ~COMPONENT_FLAG_MESH;
-    m_view_mesh.erase(std::ranges::find(m_view_mesh, entity_id));
-    m_geometry_cache.DecrementGeometryRefCount(m_components_mesh[entity_id].geometry);
-    m_material_cache.DecrementMaterialRefCount(m_components_mesh[entity_id].material);
-    m_render_scene_patches.push_back({.type = RenderScenePatch::Type::MeshRemoved, .entity_id = entity_id});
+  if(component_type == ComponentRegistry::GetTypeID<MeshComponent>()) {
+    RemoveMeshFromEntity(entity_id);
     did_remove_component = true;
   }
 
-  if(component_type == typeid(PerspectiveCameraComponent)) {
-    const EntityID entity_id = GetOrCreateEntityForNode(node);
+  if(component_type == ComponentRegistry::GetTypeID<PerspectiveCameraComponent>()) {
     m_entities[entity_id] &= ~COMPONENT_FLAG_CAMERA;
-    m_view_camera.erase(std::ranges::find(m_view_camera, entity_id));
+    m_view_camera.Remove(entity_id);
     did_remove_component = true;
   }
 
-  if(did_remove_component) {
-    const EntityID entity_id = m_node_entity_map[node];
-
-    if(m_entities[entity_id] == 0u) {
-      DestroyEntity(entity_id);
+  if(component_type == ComponentRegistry::GetTypeID<PrefabInstanceComponent>()) {
+    // The prefab may be gone already, but the mesh entities still know their geometries and materials.
+    for(const EntityID mesh_entity_id : m_components_prefab_instance[entity_id].mesh_entities) {
+      RemoveMeshFromEntity(mesh_entity_id);
+      DestroyEntity(mesh_entity_id);
     }
+    m_components_prefab_instance[entity_id].prefab = nullptr;
+    m_components_prefab_instance[entity_id].mesh_entities.clear();
+    m_entities[entity_id] &= ~COMPONENT_FLAG_PREFAB_INSTANCE;
+    did_remove_component = true;
+  }
+
+  if(did_remove_component && m_entities[entity_id] == 0u) {
+    DestroyEntity(entity_id);
+    m_node_entity_table[node_handle.index] = k_no_entity;
   }
 }
 
 void RenderScene::PatchNodeTransformChanged(SceneNode* node) {
-  const auto node_and_entity_id = m_node_entity_map.find(node);
-  if(node_and_entity_id == m_node_entity_map.end()) {
+  const EntityID entity_id = GetEntityForNode(node->GetHandle().index);
+  if(entity_id == k_no_entity) {
     return;
   }
 
-  const EntityID entity_id = node_and_entity_id->second;
-
-  Transform& entity_transform = m_components_transform[entity_id];
-  entity_transform.local_to_world = node->GetTransform().GetWorld();
+  // Only the entity IDs are passed on, stage 2 reads the new world matrices from the snapshot.
   m_render_scene_patches.push_back({.type = RenderScenePatch::Type::TransformChanged, .entity_id = entity_id});
+
+  if(m_entities[entity_id] & COMPONENT_FLAG_PREFAB_INSTANCE) {
+    for(const EntityID mesh_entity_id : m_components_prefab_instance[entity_id].mesh_entities) {
+      m_render_scene_patches.push_back({.type = RenderScenePatch::Type::TransformChanged, .entity_id = mesh_entity_id});
+    }
+  }
+}
+
+void RenderScene::AddMeshToEntity(EntityID entity_id, const Geometry* geometry, const Material* material, bool is_static) {
+  Mesh& entity_mesh = m_components_mesh[entity_id];
+  entity_mesh.geometry = geometry;
+  entity_mesh.material = material;
+  entity_mesh.is_static = is_static;
+  if(entity_mesh.material == nullptr) [[unlikely]] {
+    // TODO(fleroviux): this should ideally never happen, but what would be the best way to safeguard against it?
+    entity_mesh.material = &m_material_placeholder;
+  }
+  m_entities[entity_id] |= COMPONENT_FLAG_MESH;
+  m_view_mesh.Insert(entity_id);
+  m_geometry_cache.IncrementGeometryRefCount(entity_mesh.geometry);
+  m_material_cache.IncrementMaterialRefCount(entity_mesh.material);
+  m_render_scene_patches.push_back({.type = RenderScenePatch::Type::MeshMounted, .entity_id = entity_id});
+}
+
+void RenderScene::RemoveMeshFromEntity(EntityID entity_id) {
+  m_entities[entity_id] &= ~COMPONENT_FLAG_MESH;
+  m_view_mesh.Remove(entity_id);
+  m_geometry_cache.DecrementGeometryRefCount(m_components_mesh[entity_id].geometry);
+  m_material_cache.DecrementMaterialRefCount(m_components_mesh[entity_id].material);
+  m_render_scene_patches.push_back({.type = RenderScenePatch::Type::MeshRemoved, .entity_id = entity_id});
+}
+
+void RenderScene::CullScene() {
+  m_visible_mesh_entities.clear();
+
+  if(m_view_camera.IsEmpty()) {
+    return;
+  }
+
+  const EntityID camera_entity_id = m_view_camera[0];
+  const Matrix4 view = GetEntityWorldMatrix(camera_entity_id).Inverse();
+  const Frustum& frustum = m_components_camera[camera_entity_id].frustum;
+  const SceneGraph& scene_graph = *m_current_scene_graph;
+
+  m_cull_view = view;
+
+  /**
+   * Walk the scene graph top-down and reject entire subtrees whose cached world-space bounds are outside of the view frustum.
+   * This keeps the cost of off-screen hierarchies down to a single bounds test, instead of uploading and GPU culling each of their items.
+   * Static meshes are skipped, their render bundles stay resident in GPU memory and are culled per item on the GPU.
+   */
+  std::vector<const SceneNode*>& stack = m_cull_stack;
+  stack.push_back(scene_graph.GetRoot());
+
+  while(!stack.empty()) {
+    const SceneNode* node = stack.back();
+    stack.pop_back();
+
+    if(!scene_graph.QueryNodeWorldVisibility(node)) {
+      continue;
+    }
+
+    const Box3& subtree_bounds = scene_graph.GetSubtreeBounds(node);
+
+    if(subtree_bounds.IsEmpty() || !frustum.ContainsBox(subtree_bounds.ApplyMatrix(view))) {
+      continue;
+    }
+
+    const EntityID entity_id = GetEntityForNode(node->GetHandle().index);
+
+    if(entity_id != k_no_entity) {
+      if((m_entities[entity_id] & COMPONENT_FLAG_MESH) && !m_components_mesh[entity_id].is_static) {
+        m_visible_mesh_entities.push_back(entity_id);
+      }
+
+      if(m_entities[entity_id] & COMPONENT_FLAG_PREFAB_INSTANCE) {
+        for(const EntityID mesh_entity_id : m_components_prefab_instance[entity_id].mesh_entities) {
+          if(!m_components_mesh[mesh_entity_id].is_static) {
+            m_visible_mesh_entities.push_back(mesh_entity_id);
+          }
+        }
+      }
+    }
+
+    for(const auto& child_node : node->GetChildren()) {
+      stack.push_back(child_node.get());
+    }
+  }
+}
+
+void RenderScene::BuildDrawList() {
+  std::vector<DrawListEntry>& entries = m_draw_list_entries;
+  entries.clear();
+
+  // The render scene patches have been applied at this point, so the locations of all visible entities are valid.
+  for(const EntityID entity_id : m_visible_mesh_entities) {
+    const RenderBundleItemLocation& location = m_components_render_item_location[entity_id];
+    const f32 view_depth = -(m_cull_view * m_render_bundle.items[location.index].local_to_world[3]).Z();
+
+    entries.push_back({.sort_key = location.sort_key | GetSortKeyDepth(view_depth), .item = location.index});
+  }
+
+  RadixSort(entries, m_draw_list_sort_scratch, [](const DrawListEntry& entry) { return entry.sort_key; });
+
+  std::vector<u32>& items = m_draw_list_items;
+  std::vector<RenderBackend::DrawList::Range>& ranges = m_draw_list.ranges;
+  items.clear();
+  ranges.clear();
+
+  u64 range_render_bundle_bits = 0u;
+
+  for(const DrawListEntry& entry : entries) {
+    const u64 render_bundle_bits = entry.sort_key >> k_sort_key_render_bundle_shift;
+
+    if(ranges.empty() || render_bundle_bits != range_render_bundle_bits) {
+      ranges.push_back({.key = GetRenderBundleKey(entry.sort_key), .first_item = (u32)items.size(), .number_of_items = 0u});
+      range_render_bundle_bits = render_bundle_bits;
+    }
+
+    items.push_back(entry.item);
+    ranges.back().number_of_items++;
+  }
+
+  // Only a changed draw list has to be uploaded again, which it is not while neither the camera nor the visible items move.
+  if(items != m_draw_list.items) {
+    std::swap(items, m_draw_list.items);
+    m_draw_list.version++;
+  }
+}
+
+u64 RenderScene::GetSortKey(const RenderBackend::RenderBundleKey& render_bundle_key, u32 material_id) {
+  // The geometry layout has one bit per attribute, so every attribute must map to one of the eight layout bits of the key.
+  // Otherwise items of different layouts would end up in the same draw list range.
+  static_assert((int)RenderGeometryAttribute::Count <= 64 - k_sort_key_geometry_layout_shift, "The geometry layout must fit into the eight most significant bits of a sort key");
+
+  return (u64)(render_bundle_key.geometry_layout & 0xFFu) << k_sort_key_geometry_layout_shift |
+         (u64)render_bundle_key.uses_ibo << k_sort_key_render_bundle_shift |
+         (u64)(material_id & 0xFFFFFFu) << 24;
+}
+
+u64 RenderScene::GetSortKeyDepth(f32 view_depth) {
+  // Non-negative floats order like their bit patterns, so dropping the low mantissa bits quantizes the depth without knowing its range.
+  // Items behind the camera, which are still visible with their bounds, are drawn first.
+  return std::bit_cast<u32>(view_depth > 0.0f ? view_depth : 0.0f) >> 8;
+}
+
+RenderBackend::RenderBundleKey RenderScene::GetRenderBundleKey(u64 sort_key) {
+  return {.uses_ibo = ((sort_key >> k_sort_key_render_bundle_shift) & 1u) != 0u, .geometry_layout = (u32)(sort_key >> k_sort_key_geometry_layout_shift)};
+}
+
+Matrix4 RenderScene::GetEntityWorldMatrix(EntityID entity_id) const {
+  const Transform& entity_transform = m_components_transform[entity_id];
+
+  if(entity_transform.is_prefab_mesh) {
+    return m_world_matrices[entity_transform.world_matrix_index] * entity_transform.local_to_prefab;
+  }
+  return m_world_matrices[entity_transform.world_matrix_index];
+}
+
+RenderScene::EntityID RenderScene::GetEntityForNode(u32 node_handle_index) const {
+  return node_handle_index < m_node_entity_table.size() ? m_node_entity_table[node_handle_index] : k_no_entity;
 }
 
 RenderScene::EntityID RenderScene::GetOrCreateEntityForNode(const SceneNode* node) {
-  const auto node_and_entity_id = m_node_entity_map.find(node);
+  const u32 node_handle_index = node->GetHandle().index;
+  EntityID entity_id = GetEntityForNode(node_handle_index);
+
+  if(entity_id == k_no_entity) {
+    entity_id = CreateEntity();
+    m_components_transform[entity_id] = {.world_matrix_index = node_handle_index, .is_prefab_mesh = false, .local_to_prefab = Matrix4::Identity()};
 
-  if(node_and_entity_id == m_node_entity_map.end()) {
-    const EntityID entity_id = CreateEntity();
-    m_node_entity_map[node] = entity_id;
-    return entity_id;
+    if(node_handle_index >= m_node_entity_table.size()) {
+      m_node_entity_table.resize(node_handle_index + 1u, k_no_entity);
+    }
+    m_node_entity_table[node_handle_index] = entity_id;
   }
 
-  return node_and_entity_id->second;
+  return entity_id;
 }
 
 RenderScene::EntityID RenderScene::CreateEntity() {
@@ -267,6 +658,8 @@ void RenderScene::ResizeComponentStorage(size_t capacity) {
   m_components_transform.resize(capacity);
   m_components_mesh.resize(capacity);
   m_components_camera.resize(capacity);
+  m_components_prefab_instance.resize(capacity);
+  m_components_render_item_location.resize(capacity);
 }
 
 } // namespace zephyr
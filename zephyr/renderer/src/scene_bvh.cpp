@@ -0,0 +1,379 @@
+
+#include <zephyr/renderer/component/mesh.hpp>
+#include <zephyr/renderer/component/prefab_instance.hpp>
+#include <zephyr/renderer/scene_bvh.hpp>
+#include <zephyr/scene/scene_node.hpp>
+#include <algorithm>
+#include <span>
+
+namespace zephyr {
+
+static f32 GetSurfaceArea(const Box3& box) {
+  const Vector3 extent = box.Max() - box.Min();
+  return 2.0f * (extent.X() * extent.Y() + extent.Y() * extent.Z() + extent.Z() * extent.X());
+}
+
+static bool IsIndexedComponentType(ComponentTypeID component_type) {
+  return component_type == ComponentRegistry::GetTypeID<MeshComponent>() ||
+         component_type == ComponentRegistry::GetTypeID<PrefabInstanceComponent>();
+}
+
+static bool HasIndexedComponent(const SceneNode* node) {
+  return node->HasComponent<MeshComponent>() || node->HasComponent<PrefabInstanceComponent>();
+}
+
+/// @returns the local bounds of all components of a node, which are indexed by the hierarchy.
+static Box3 GetIndexedLocalBounds(const SceneNode* node) {
+  Box3 bounds = Box3::Empty();
+
+  if(node->HasComponent<MeshComponent>()) {
+    bounds = bounds.Union(node->GetComponent<MeshComponent>().GetLocalBounds());
+  }
+
+  if(node->HasComponent<PrefabInstanceComponent>()) {
+    bounds = bounds.Union(node->GetComponent<PrefabInstanceComponent>().GetLocalBounds());
+  }
+  return bounds;
+}
+
+void SceneBVH::Rebuild(const SceneGraph& scene_graph) {
+  m_nodes.clear();
+  m_root = k_null_node;
+  m_free_list = k_null_node;
+  m_leaf_of_scene_node.clear();
+
+  const auto insert_visible_nodes = [&](std::span<SceneNode* const> nodes) {
+    for(const SceneNode* node : nodes) {
+      if(node->GetSceneGraph() == &scene_graph && scene_graph.QueryNodeWorldVisibility(node)) {
+        InsertOrUpdate(node);
+      }
+    }
+  };
+
+  // Nodes with both a mesh and a prefab instance are visited twice, but the second visit finds the leaf up-to-date already.
+  insert_visible_nodes(ComponentPool<MeshComponent>::Get().GetNodes());
+  insert_visible_nodes(ComponentPool<PrefabInstanceComponent>::Get().GetNodes());
+}
+
+void SceneBVH::ApplyScenePatches(SceneGraph& scene_graph) {
+  for(const ScenePatch& patch : scene_graph.GetScenePatches()) {
+    switch(patch.type) {
+      case ScenePatch::Type::NodeMounted:
+      case ScenePatch::Type::NodeTransformChanged: {
+        const SceneNode* node = scene_graph.GetNode(patch.node);
+        if(HasIndexedComponent(node)) {
+          InsertOrUpdate(node);
+        }
+        break;
+      }
+      case ScenePatch::Type::NodeRemoved: {
+        Remove(patch.node);
+        break;
+      }
+      case ScenePatch::Type::ComponentMounted:
+      case ScenePatch::Type::ComponentRemoved: {
+        if(IsIndexedComponentType(patch.component_type)) {
+          // The node may still have another indexed component, in which case only its bounds change.
+          const SceneNode* node = scene_graph.GetNode(patch.node);
+          if(node && HasIndexedComponent(node)) {
+            InsertOrUpdate(node);
+          } else {
+            Remove(patch.node);
+          }
+        }
+        break;
+      }
+    }
+  }
+}
+
+void SceneBVH::QueryFrustum(const Frustum& frustum, std::vector<SceneNodeHandle>& out_nodes) const {
+  Query([&](const Box3& box) { return frustum.ContainsBox(box); }, out_nodes);
+}
+
+void SceneBVH::QueryBox(const Box3& box, std::vector<SceneNodeHandle>& out_nodes) const {
+  Query([&](const Box3& node_box) { return box.Intersects(node_box); }, out_nodes);
+}
+
+void SceneBVH::QueryRay(const Vector3& origin, const Vector3& direction, f32 max_distance, std::vector<SceneNodeHandle>& out_nodes) const {
+  const Vector3 inverse_direction{1.0f / direction.X(), 1.0f / direction.Y(), 1.0f / direction.Z()};
+
+  // Slab test: intersect the ray with the three pairs of planes bounding the box and check if the resulting intervals overlap.
+  Query([&](const Box3& box) {
+    f32 t_min = 0.0f;
+    f32 t_max = max_distance;
+
+    for(int i = 0; i < 3; i++) {
+      // A ray parallel to the slab never enters or leaves it, 0 * inf would turn the interval into NaNs though.
+      if(direction[i] == 0.0f) {
+        if(origin[i] < box.Min()[i] || origin[i] > box.Max()[i]) {
+          return false;
+        }
+        continue;
+      }
+
+      const f32 t0 = (box.Min()[i] - origin[i]) * inverse_direction[i];
+      const f32 t1 = (box.Max()[i] - origin[i]) * inverse_direction[i];
+      t_min = std::max(t_min, std::min(t0, t1));
+      t_max = std::min(t_max, std::max(t0, t1));
+    }
+    return t_min <= t_max;
+  }, out_nodes);
+}
+
+template<typename Predicate>
+void SceneBVH::Query(const Predicate& predicate, std::vector<SceneNodeHandle>& out_nodes) const {
+  if(m_root == k_null_node) {
+    return;
+  }
+
+  // Each query leaves the stack empty, so one stack per thread can be reused by all queries without allocating memory again.
+  thread_local std::vector<u32> stack{};
+  stack.push_back(m_root);
+
+  while(!stack.empty()) {
+    const u32 index = stack.back();
+    stack.pop_back();
+
+    const Node& node = m_nodes[index];
+    if(!predicate(node.box)) {
+      continue;
+    }
+
+    if(IsLeaf(index)) {
+      out_nodes.push_back(node.scene_node);
+    } else {
+      stack.push_back(node.children[0]);
+      stack.push_back(node.children[1]);
+    }
+  }
+}
+
+void SceneBVH::InsertOrUpdate(const SceneNode* node) {
+  const Box3 local_bounds = GetIndexedLocalBounds(node);
+  const SceneNodeHandle handle = node->GetHandle();
+
+  if(local_bounds.IsEmpty()) {
+    Remove(handle);
+    return;
+  }
+
+  const Box3 box = local_bounds.ApplyMatrix(node->GetTransform().GetWorld());
+
+  if(handle.index >= m_leaf_of_scene_node.size()) {
+    m_leaf_of_scene_node.resize(handle.index + 1u, k_null_node);
+  }
+
+  u32 leaf = m_leaf_of_scene_node[handle.index];
+
+  if(leaf != k_null_node) {
+    // Nothing to do as long as the enlarged bounds of the leaf still enclose the node.
+    if(m_nodes[leaf].box.Contains(box)) {
+      return;
+    }
+    RemoveLeaf(leaf);
+  } else {
+    leaf = AllocateNode();
+    m_nodes[leaf].scene_node = handle;
+    m_leaf_of_scene_node[handle.index] = leaf;
+  }
+
+  const Vector3 margin{k_leaf_margin, k_leaf_margin, k_leaf_margin};
+  m_nodes[leaf].box = Box3{box.Min() - margin, box.Max() + margin};
+  InsertLeaf(leaf);
+}
+
+void SceneBVH::Remove(SceneNodeHandle handle) {
+  if(handle.index >= m_leaf_of_scene_node.size()) {
+    return;
+  }
+
+  const u32 leaf = m_leaf_of_scene_node[handle.index];
+
+  if(leaf != k_null_node) {
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+    m_leaf_of_scene_node[handle.index] = k_null_node;
+  }
+}
+
+u32 SceneBVH::AllocateNode() {
+  u32 index = m_free_list;
+
+  if(index == k_null_node) {
+    index = (u32)m_nodes.size();
+    m_nodes.emplace_back();
+  } else {
+    m_free_list = m_nodes[index].parent;
+    m_nodes[index] = {};
+  }
+  return index;
+}
+
+void SceneBVH::FreeNode(u32 index) {
+  m_nodes[index].parent = m_free_list;
+  m_nodes[index].height = -1;
+  m_free_list = index;
+}
+
+void SceneBVH::InsertLeaf(u32 leaf) {
+  if(m_root == k_null_node) {
+    m_root = leaf;
+    m_nodes[leaf].parent = k_null_node;
+    return;
+  }
+
+  const Box3 leaf_box = m_nodes[leaf].box;
+
+  // Descend to the sibling which minimizes the increase in total surface area.
+  u32 index = m_root;
+
+  while(!IsLeaf(index)) {
+    const Node& node = m_nodes[index];
+    const f32 area = GetSurfaceArea(node.box);
+    const f32 combined_area = GetSurfaceArea(node.box.Union(leaf_box));
+
+    // Cost of creating a new parent for this node and the leaf, versus the minimum cost of pushing the leaf further down.
+    const f32 cost = 2.0f * combined_area;
+    const f32 inheritance_cost = 2.0f * (combined_area - area);
+
+    f32 child_costs[2];
+
+    for(int i = 0; i < 2; i++) {
+      const Node& child = m_nodes[node.children[i]];
+      const f32 child_combined_area = GetSurfaceArea(child.box.Union(leaf_box));
+
+      if(IsLeaf(node.children[i])) {
+        child_costs[i] = child_combined_area + inheritance_cost;
+      } else {
+        child_costs[i] = child_combined_area - GetSurfaceArea(child.box) + inheritance_cost;
+      }
+    }
+
+    if(cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+    index = child_costs[0] < child_costs[1] ? node.children[0] : node.children[1];
+  }
+
+  const u32 sibling = index;
+  const u32 old_parent = m_nodes[sibling].parent;
+  const u32 new_parent = AllocateNode();
+
+  m_nodes[new_parent].parent = old_parent;
+  m_nodes[new_parent].box = m_nodes[sibling].box.Union(leaf_box);
+  m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+  m_nodes[new_parent].children[0] = sibling;
+  m_nodes[new_parent].children[1] = leaf;
+  m_nodes[sibling].parent = new_parent;
+  m_nodes[leaf].parent = new_parent;
+
+  if(old_parent != k_null_node) {
+    u32* children = m_nodes[old_parent].children;
+    children[children[0] == sibling ? 0 : 1] = new_parent;
+  } else {
+    m_root = new_parent;
+  }
+
+  RefitAncestors(m_nodes[leaf].parent);
+}
+
+void SceneBVH::RemoveLeaf(u32 leaf) {
+  if(leaf == m_root) {
+    m_root = k_null_node;
+    return;
+  }
+
+  const u32 parent = m_nodes[leaf].parent;
+  const u32 grand_parent = m_nodes[parent].parent;
+  const u32 sibling = m_nodes[parent].children[0] == leaf ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+
+  // Replace the parent with the sibling of the leaf.
+  m_nodes[sibling].parent = grand_parent;
+  FreeNode(parent);
+
+  if(grand_parent != k_null_node) {
+    u32* children = m_nodes[grand_parent].children;
+    children[children[0] == parent ? 0 : 1] = sibling;
+    RefitAncestors(grand_parent);
+  } else {
+    m_root = sibling;
+  }
+}
+
+void SceneBVH::RefitAncestors(u32 index) {
+  while(index != k_null_node) {
+    index = Balance(index);
+
+    Node& node = m_nodes[index];
+    const Node& child_a = m_nodes[node.children[0]];
+    const Node& child_b = m_nodes[node.children[1]];
+    node.height = 1 + std::max(child_a.height, child_b.height);
+    node.box = child_a.box.Union(child_b.box);
+
+    index = node.parent;
+  }
+}
+
+u32 SceneBVH::Balance(u32 index_a) {
+  Node& a = m_nodes[index_a];
+
+  if(IsLeaf(index_a) || a.height < 2) {
+    return index_a;
+  }
+
+  const u32 index_b = a.children[0];
+  const u32 index_c = a.children[1];
+  Node& b = m_nodes[index_b];
+  Node& c = m_nodes[index_c];
+
+  const s32 balance = c.height - b.height;
+
+  // If one subtree is more than one level taller than the other, rotate its root up to become the new root of A's subtree.
+  if(balance > 1 || balance < -1) {
+    const u32 index_up = balance > 1 ? index_c : index_b;
+    const u32 index_stay = balance > 1 ? index_b : index_c;
+    const int up_slot = balance > 1 ? 1 : 0;
+    Node& up = m_nodes[index_up];
+    const Node& stay = m_nodes[index_stay];
+
+    const u32 index_f = up.children[0];
+    const u32 index_g = up.children[1];
+    Node& f = m_nodes[index_f];
+    Node& g = m_nodes[index_g];
+
+    // Swap A and the rotated node.
+    up.children[0] = index_a;
+    up.parent = a.parent;
+    a.parent = index_up;
+
+    if(up.parent != k_null_node) {
+      u32* children = m_nodes[up.parent].children;
+      children[children[0] == index_a ? 0 : 1] = index_up;
+    } else {
+      m_root = index_up;
+    }
+
+    // The taller grandchild stays with the rotated node, the shorter one takes its place below A.
+    const bool keep_f = f.height > g.height;
+    const u32 index_kept = keep_f ? index_f : index_g;
+    const u32 index_moved = keep_f ? index_g : index_f;
+    Node& kept = m_nodes[index_kept];
+    Node& moved = m_nodes[index_moved];
+
+    up.children[1] = index_kept;
+    a.children[up_slot] = index_moved;
+    moved.parent = index_a;
+
+    a.box = stay.box.Union(moved.box);
+    a.height = 1 + std::max(stay.height, moved.height);
+    up.box = a.box.Union(kept.box);
+    up.height = 1 + std::max(a.height, kept.height);
+
+    return index_up;
+  }
+
+  return index_a;
+}
+
+} // namespace zephyr
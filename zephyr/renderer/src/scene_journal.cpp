@@ -0,0 +1,680 @@
+#include <zephyr/renderer/component/camera.hpp>
+#include <zephyr/renderer/component/mesh.hpp>
+#include <zephyr/renderer/component/prefab_instance.hpp>
+#include <zephyr/renderer/scene_journal.hpp>
+#include <zephyr/panic.hpp>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace zephyr {
+
+namespace {
+
+constexpr char k_journal_magic[8] = {'Z', 'J', 'O', 'U', 'R', 'N', 'A', 'L'};
+constexpr u32 k_journal_version = 1u;
+constexpr u32 k_no_id = ~0u;
+constexpr u64 k_no_node = ~0ull;
+constexpr u64 k_record_alignment = 16u;
+
+/**
+ * A journal is a header followed by a flat sequence of records. Each frame starts with a frame record and all records are padded
+ * to a multiple of 16 bytes, so that the fixed-size part at the beginning of each record can be read in place from the mapped file.
+ */
+enum JournalRecordType : u32 {
+  JOURNAL_RECORD_FRAME,
+  JOURNAL_RECORD_GEOMETRY,
+  JOURNAL_RECORD_MATERIAL,
+  JOURNAL_RECORD_TEXTURE,
+  JOURNAL_RECORD_PREFAB,
+  JOURNAL_RECORD_NODE_MOUNTED,
+  JOURNAL_RECORD_NODE_REMOVED,
+  JOURNAL_RECORD_NODE_HIDDEN,
+  JOURNAL_RECORD_NODE_COMPONENTS_CHANGED,
+  JOURNAL_RECORD_NODE_TRANSFORM_CHANGED
+};
+
+enum JournalNodeFlag : u32 {
+  JOURNAL_NODE_FLAG_STATIC = 1u << 0,
+  JOURNAL_NODE_FLAG_MESH = 1u << 1,
+  JOURNAL_NODE_FLAG_CAMERA = 1u << 2,
+  JOURNAL_NODE_FLAG_PREFAB_INSTANCE = 1u << 3
+};
+
+struct JournalHeader {
+  char magic[8];
+  u32 version;
+  u32 reserved;
+};
+
+struct JournalRecordHeader {
+  u32 type;
+  u32 reserved;
+  u64 size; //< Size of the record without the header and padding
+};
+
+struct JournalTransform {
+  f32 position[3];
+  f32 rotation[4]; //< W, X, Y, Z
+  f32 scale[3];
+};
+
+/// Used by node mounted and components changed records. Followed by the name of the node.
+struct JournalNode {
+  u64 node;
+  u64 parent; //< The handle of the parent node or k_no_node for the root node
+  u32 flags;
+  u32 name_length;
+  JournalTransform transform;
+  u32 geometry; //< Resource ID of the mesh geometry or k_no_id
+  u32 material; //< Resource ID of the mesh material or k_no_id
+  u32 prefab; //< Prefab ID of the prefab instance or k_no_id
+  f32 camera[4]; //< Field of view, aspect ratio, near and far plane of the camera
+};
+
+/// Used by node removed and node hidden records.
+struct JournalNodeHandle {
+  u64 node;
+};
+
+struct JournalNodeTransform {
+  u64 node;
+  JournalTransform transform;
+};
+
+/// Followed by the vertex data and the index data.
+struct JournalGeometry {
+  u32 id;
+  u32 layout_key;
+  u64 number_of_vertices;
+  u64 number_of_indices;
+};
+
+struct JournalMaterial {
+  u32 id;
+  u32 diffuse_map; //< Resource ID of the texture or k_no_id
+};
+
+/// Followed by the texture data.
+struct JournalTexture {
+  u32 id;
+  u32 width;
+  u32 height;
+  u32 format;
+  u32 data_type;
+  u32 color_space;
+  u64 data_size;
+};
+
+/// Followed by the meshes of the prefab.
+struct JournalPrefab {
+  u32 id;
+  u32 number_of_meshes;
+};
+
+struct JournalPrefabMesh {
+  u32 geometry;
+  u32 material;
+  f32 local_to_prefab[16];
+};
+
+static_assert(sizeof(JournalHeader) == k_record_alignment && sizeof(JournalRecordHeader) == k_record_alignment);
+static_assert(std::is_trivially_copyable_v<JournalNode> && std::is_trivially_copyable_v<JournalNodeTransform> && std::is_trivially_copyable_v<JournalPrefabMesh>);
+static_assert(sizeof(Matrix4) == sizeof(JournalPrefabMesh::local_to_prefab));
+
+u64 AlignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+template<typename T>
+std::span<const u8> AsBytes(const T& value) {
+  return {(const u8*)&value, sizeof(T)};
+}
+
+u64 EncodeHandle(SceneNodeHandle handle) {
+  return handle.IsValid() ? ((u64)handle.generation << 32) | handle.index : k_no_node;
+}
+
+JournalTransform EncodeTransform(const Transform3D& transform) {
+  const Vector3& position = transform.GetPosition();
+  const Quaternion& rotation = transform.GetRotation();
+  const Vector3& scale = transform.GetScale();
+
+  return {
+    .position = {position.X(), position.Y(), position.Z()},
+    .rotation = {rotation.W(), rotation.X(), rotation.Y(), rotation.Z()},
+    .scale = {scale.X(), scale.Y(), scale.Z()}
+  };
+}
+
+/// @returns a pointer to an array of count elements at an offset into the data of a record.
+template<typename T>
+const T* ReadRecord(std::span<const u8> data, const std::filesystem::path& path, size_t offset = 0u, size_t count = 1u) {
+  if(offset > data.size() || count > (data.size() - offset) / sizeof(T)) {
+    ZEPHYR_PANIC("Scene journal is corrupt: {}", path.string());
+  }
+  return (const T*)(data.data() + offset);
+}
+
+void ApplyTransform(SceneNode* node, const JournalTransform& journal_transform) {
+  Transform3D& transform = node->GetTransform();
+  transform.SetPosition({journal_transform.position[0], journal_transform.position[1], journal_transform.position[2]});
+  transform.SetRotation({journal_transform.rotation[0], journal_transform.rotation[1], journal_transform.rotation[2], journal_transform.rotation[3]});
+  transform.SetScale({journal_transform.scale[0], journal_transform.scale[1], journal_transform.scale[2]});
+}
+
+} // anonymous namespace
+
+SceneJournalRecorder::SceneJournalRecorder(const std::filesystem::path& path)
+    : m_path{path}
+    , m_file{path, std::ios::binary | std::ios::trunc} {
+  if(!m_file.good()) {
+    ZEPHYR_PANIC("Failed to open scene journal for writing: {}", path.string());
+  }
+
+  JournalHeader header{};
+  std::memcpy(header.magic, k_journal_magic, sizeof(header.magic));
+  header.version = k_journal_version;
+  m_file.write((const char*)&header, sizeof(header));
+}
+
+void SceneJournalRecorder::RecordFrame(SceneGraph& scene_graph) {
+  WriteRecord(JOURNAL_RECORD_FRAME, {});
+
+  if(!m_recorded_full_state) {
+    RecordFullState(scene_graph);
+    m_recorded_full_state = true;
+  } else {
+    // Write modified resources first, since the replayer must see their new contents when it replays the patches.
+    RecordChangedResources();
+    RecordScenePatches(scene_graph);
+  }
+
+  if(!m_file.good()) {
+    ZEPHYR_PANIC("Failed to write scene journal: {}", m_path.string());
+  }
+}
+
+void SceneJournalRecorder::RecordFullState(SceneGraph& scene_graph) {
+  // Write all nodes which are visible in the world in pre-order, so that parents are always mounted before their children.
+  scene_graph.GetRoot()->Traverse([&](const SceneNode* node) {
+    if(!scene_graph.QueryNodeWorldVisibility(node)) {
+      return false;
+    }
+    WriteNode(JOURNAL_RECORD_NODE_MOUNTED, node);
+    return true;
+  });
+}
+
+void SceneJournalRecorder::RecordScenePatches(SceneGraph& scene_graph) {
+  for(const ScenePatch& patch : scene_graph.GetScenePatches()) {
+    switch(patch.type) {
+      case ScenePatch::Type::NodeMounted: {
+        WriteNode(JOURNAL_RECORD_NODE_MOUNTED, scene_graph.GetNode(patch.node));
+        break;
+      }
+      case ScenePatch::Type::NodeRemoved: {
+        // Nodes that merely became invisible keep their handle, while the handles of removed nodes are stale.
+        const JournalNodeHandle record{.node = EncodeHandle(patch.node)};
+        WriteRecord(scene_graph.GetNode(patch.node) ? JOURNAL_RECORD_NODE_HIDDEN : JOURNAL_RECORD_NODE_REMOVED, {AsBytes(record)});
+        break;
+      }
+      case ScenePatch::Type::ComponentMounted:
+      case ScenePatch::Type::ComponentRemoved: {
+        WriteNode(JOURNAL_RECORD_NODE_COMPONENTS_CHANGED, scene_graph.GetNode(patch.node));
+        break;
+      }
+      case ScenePatch::Type::NodeTransformChanged: {
+        // Static nodes only move along with their ancestors, whose own records reproduce the change.
+        if(scene_graph.GetNode(patch.node)->IsStatic()) {
+          break;
+        }
+
+        const JournalNodeTransform record{
+          .node = EncodeHandle(patch.node),
+          .transform = EncodeTransform(scene_graph.GetNode(patch.node)->GetTransform())
+        };
+        WriteRecord(JOURNAL_RECORD_NODE_TRANSFORM_CHANGED, {AsBytes(record)});
+        break;
+      }
+    }
+  }
+}
+
+void SceneJournalRecorder::RecordChangedResources() {
+  // Writing a material may record a new texture, so m_resources may grow during the loop.
+  for(u32 id = 0u; id < m_resources.size(); id++) {
+    if(m_resources[id].resource->CurrentVersion() != m_resources[id].version) {
+      WriteResource(id);
+    }
+  }
+}
+
+void SceneJournalRecorder::WriteNode(u32 type, const SceneNode* node) {
+  JournalNode record{};
+  record.node = EncodeHandle(node->GetHandle());
+  record.parent = node->GetParent() ? EncodeHandle(node->GetParent()->GetHandle()) : k_no_node;
+  record.flags = node->IsStatic() ? JOURNAL_NODE_FLAG_STATIC : 0u;
+  record.name_length = (u32)node->GetName().size();
+  record.transform = EncodeTransform(node->GetTransform());
+  record.geometry = k_no_id;
+  record.material = k_no_id;
+  record.prefab = k_no_id;
+
+  // Resolving the resources may write resource records, which must precede the node record.
+  if(node->HasComponent<MeshComponent>()) {
+    const MeshComponent& mesh_component = node->GetComponent<MeshComponent>();
+    record.flags |= JOURNAL_NODE_FLAG_MESH;
+    record.geometry = GetResourceID(mesh_component.geometry, ResourceType::Geometry);
+    record.material = GetResourceID(mesh_component.material, ResourceType::Material);
+  }
+
+  if(node->HasComponent<PerspectiveCameraComponent>()) {
+    const PerspectiveCameraComponent& camera_component = node->GetComponent<PerspectiveCameraComponent>();
+    record.flags |= JOURNAL_NODE_FLAG_CAMERA;
+    record.camera[0] = camera_component.GetFieldOfView();
+    record.camera[1] = camera_component.GetAspectRatio();
+    record.camera[2] = camera_component.GetNear();
+    record.camera[3] = camera_component.GetFar();
+  }
+
+  if(node->HasComponent<PrefabInstanceComponent>()) {
+    record.flags |= JOURNAL_NODE_FLAG_PREFAB_INSTANCE;
+    record.prefab = GetPrefabID(node->GetComponent<PrefabInstanceComponent>().prefab);
+  }
+
+  const std::string& name = node->GetName();
+  WriteRecord(type, {AsBytes(record), {(const u8*)name.data(), name.size()}});
+}
+
+void SceneJournalRecorder::WriteResource(u32 id) {
+  // Keep a reference, since recording the diffuse map of a material may reallocate m_resources.
+  const std::shared_ptr<const Resource> resource = m_resources[id].resource;
+  m_resources[id].version = resource->CurrentVersion();
+
+  switch(m_resources[id].type) {
+    case ResourceType::Geometry: {
+      const auto geometry = (const Geometry*)resource.get();
+      const JournalGeometry record{
+        .id = id,
+        .layout_key = geometry->GetLayout().key,
+        .number_of_vertices = geometry->GetNumberOfVertices(),
+        .number_of_indices = geometry->GetNumberOfIndices()
+      };
+      WriteRecord(JOURNAL_RECORD_GEOMETRY, {AsBytes(record), geometry->GetRawVertexData(), geometry->GetRawIndexData()});
+      break;
+    }
+    case ResourceType::Material: {
+      const auto material = (const Material*)resource.get();
+      const JournalMaterial record{.id = id, .diffuse_map = GetResourceID(material->m_diffuse_map, ResourceType::Texture)};
+      WriteRecord(JOURNAL_RECORD_MATERIAL, {AsBytes(record)});
+      break;
+    }
+    case ResourceType::Texture: {
+      const auto texture = (const Texture2D*)resource.get();
+      const JournalTexture record{
+        .id = id,
+        .width = texture->GetWidth(),
+        .height = texture->GetHeight(),
+        .format = (u32)texture->GetFormat(),
+        .data_type = (u32)texture->GetDataType(),
+        .color_space = (u32)texture->GetColorSpace(),
+        .data_size = texture->Size()
+      };
+      WriteRecord(JOURNAL_RECORD_TEXTURE, {AsBytes(record), {(const u8*)texture->Data(), texture->Size()}});
+      break;
+    }
+  }
+}
+
+void SceneJournalRecorder::WriteRecord(u32 type, std::initializer_list<std::span<const u8>> parts) {
+  JournalRecordHeader header{.type = type, .reserved = 0u, .size = 0u};
+
+  for(const std::span<const u8> part : parts) {
+    header.size += part.size();
+  }
+
+  m_file.write((const char*)&header, sizeof(header));
+
+  for(const std::span<const u8> part : parts) {
+    m_file.write((const char*)part.data(), (std::streamsize)part.size());
+  }
+
+  static constexpr char padding[k_record_alignment]{};
+  m_file.write(padding, (std::streamsize)(AlignUp(header.size, k_record_alignment) - header.size));
+}
+
+u32 SceneJournalRecorder::GetResourceID(std::shared_ptr<const Resource> resource, ResourceType type) {
+  if(!resource) {
+    return k_no_id;
+  }
+
+  const auto [match, inserted] = m_resource_ids.try_emplace(resource.get(), (u32)m_resources.size());
+  if(inserted) {
+    m_resources.push_back({.resource = std::move(resource), .type = type, .version = 0u});
+    WriteResource(match->second);
+  }
+  return match->second;
+}
+
+u32 SceneJournalRecorder::GetPrefabID(const std::shared_ptr<const Prefab>& prefab) {
+  if(!prefab) {
+    return k_no_id;
+  }
+
+  const auto [match, inserted] = m_prefab_ids.try_emplace(prefab.get(), (u32)m_prefabs.size());
+  if(inserted) {
+    m_prefabs.push_back(prefab);
+
+    std::vector<JournalPrefabMesh> meshes{};
+
+    for(const Prefab::Mesh& mesh : prefab->GetMeshes()) {
+      JournalPrefabMesh& journal_mesh = meshes.emplace_back();
+      journal_mesh.geometry = GetResourceID(mesh.geometry, ResourceType::Geometry);
+      journal_mesh.material = GetResourceID(mesh.material, ResourceType::Material);
+      std::memcpy(journal_mesh.local_to_prefab, &mesh.local_to_prefab, sizeof(journal_mesh.local_to_prefab));
+    }
+
+    const JournalPrefab record{.id = match->second, .number_of_meshes = (u32)meshes.size()};
+    WriteRecord(JOURNAL_RECORD_PREFAB, {AsBytes(record), {(const u8*)meshes.data(), meshes.size() * sizeof(JournalPrefabMesh)}});
+  }
+  return match->second;
+}
+
+SceneJournalPlayer::SceneJournalPlayer(const std::filesystem::path& path)
+    : m_path{path}
+    , m_file{path}
+    , m_scene_graph{std::make_shared<SceneGraph>()} {
+  const JournalHeader& header = *(const JournalHeader*)GetRange(0u, sizeof(JournalHeader));
+
+  if(std::memcmp(header.magic, k_journal_magic, sizeof(header.magic)) != 0 || header.version != k_journal_version) {
+    ZEPHYR_PANIC("File is not a scene journal or has an unsupported version: {}", path.string());
+  }
+
+  m_read_offset = sizeof(JournalHeader);
+}
+
+bool SceneJournalPlayer::ReplayFrame() {
+  const u64 file_size = m_file.GetData().size();
+
+  if(m_read_offset >= file_size) {
+    return false;
+  }
+
+  bool read_frame_record = false;
+
+  while(m_read_offset < file_size) {
+    const JournalRecordHeader& header = *(const JournalRecordHeader*)GetRange(m_read_offset, sizeof(JournalRecordHeader));
+
+    if(header.type == JOURNAL_RECORD_FRAME) {
+      // Stop in front of the next frame.
+      if(read_frame_record) {
+        break;
+      }
+      read_frame_record = true;
+    } else if(!read_frame_record) {
+      ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+    }
+
+    const u8* data = GetRange(m_read_offset + sizeof(JournalRecordHeader), header.size);
+    m_read_offset += sizeof(JournalRecordHeader) + AlignUp(header.size, k_record_alignment);
+
+    if(header.type != JOURNAL_RECORD_FRAME) {
+      ReplayRecord(header.type, {data, (size_t)header.size});
+    }
+  }
+
+  return true;
+}
+
+const u8* SceneJournalPlayer::GetRange(u64 offset, u64 size) const {
+  const std::span<const u8> data = m_file.GetData();
+
+  if(offset > data.size() || size > data.size() - offset) {
+    ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+  }
+  return data.data() + offset;
+}
+
+SceneNode* SceneJournalPlayer::GetNode(u64 recorded_handle) const {
+  const auto match = m_nodes.find(recorded_handle);
+  return match != m_nodes.end() ? match->second : nullptr;
+}
+
+template<typename T>
+std::shared_ptr<T> SceneJournalPlayer::GetResource(const std::unordered_map<u32, std::shared_ptr<T>>& resources, u32 id) const {
+  if(id == k_no_id) {
+    return nullptr;
+  }
+
+  const auto match = resources.find(id);
+  if(match == resources.end()) {
+    ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+  }
+  return match->second;
+}
+
+void SceneJournalPlayer::ReplayRecord(u32 type, std::span<const u8> data) {
+  // Bring the components of a node in line with the record. Components are only recreated when they changed, to not emit redundant patches.
+  const auto ApplyComponents = [&](SceneNode* node, const JournalNode& record) {
+    const std::shared_ptr<Geometry> geometry = GetResource(m_geometries, record.geometry);
+    const std::shared_ptr<Material> material = GetResource(m_materials, record.material);
+
+    if(node->HasComponent<MeshComponent>()) {
+      const MeshComponent& mesh_component = node->GetComponent<MeshComponent>();
+
+      if(!(record.flags & JOURNAL_NODE_FLAG_MESH) || mesh_component.geometry != geometry || mesh_component.material != material) {
+        node->RemoveComponent<MeshComponent>();
+      }
+    }
+
+    if((record.flags & JOURNAL_NODE_FLAG_MESH) && !node->HasComponent<MeshComponent>()) {
+      node->CreateComponent<MeshComponent>(geometry, material);
+    }
+
+    if(record.flags & JOURNAL_NODE_FLAG_CAMERA) {
+      if(node->HasComponent<PerspectiveCameraComponent>()) {
+        node->GetComponent<PerspectiveCameraComponent>().Setup(record.camera[0], record.camera[1], record.camera[2], record.camera[3]);
+      } else {
+        node->CreateComponent<PerspectiveCameraComponent>(record.camera[0], record.camera[1], record.camera[2], record.camera[3]);
+      }
+    } else if(node->HasComponent<PerspectiveCameraComponent>()) {
+      node->RemoveComponent<PerspectiveCameraComponent>();
+    }
+
+    const std::shared_ptr<const Prefab> prefab = GetResource(m_prefabs, record.prefab);
+
+    if(node->HasComponent<PrefabInstanceComponent>()) {
+      if(!(record.flags & JOURNAL_NODE_FLAG_PREFAB_INSTANCE) || node->GetComponent<PrefabInstanceComponent>().prefab != prefab) {
+        node->RemoveComponent<PrefabInstanceComponent>();
+      }
+    }
+
+    if((record.flags & JOURNAL_NODE_FLAG_PREFAB_INSTANCE) && !node->HasComponent<PrefabInstanceComponent>()) {
+      node->CreateComponent<PrefabInstanceComponent>(prefab);
+    }
+  };
+
+  switch(type) {
+    case JOURNAL_RECORD_GEOMETRY: {
+      const JournalGeometry& record = *ReadRecord<JournalGeometry>(data, m_path);
+
+      std::shared_ptr<Geometry>& geometry = m_geometries[record.id];
+      if(!geometry) {
+        geometry = std::make_shared<Geometry>(RenderGeometryLayout{record.layout_key}, (size_t)record.number_of_vertices, (size_t)record.number_of_indices);
+      } else if(geometry->GetLayout().key != record.layout_key) {
+        ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+      } else {
+        geometry->SetNumberOfVertices((size_t)record.number_of_vertices);
+        geometry->SetNumberOfIndices((size_t)record.number_of_indices);
+        geometry->MarkAsDirty();
+      }
+
+      const std::span<u8> vertex_data = geometry->GetRawVertexData();
+      const std::span<u8> index_data = geometry->GetRawIndexData();
+      // Empty geometries and geometries without indices have no buffer at all, which must not be passed to memcpy().
+      if(!vertex_data.empty()) {
+        std::memcpy(vertex_data.data(), ReadRecord<u8>(data, m_path, sizeof(JournalGeometry), vertex_data.size()), vertex_data.size());
+      }
+
+      if(!index_data.empty()) {
+        std::memcpy(index_data.data(), ReadRecord<u8>(data, m_path, sizeof(JournalGeometry) + vertex_data.size(), index_data.size()), index_data.size());
+      }
+      break;
+    }
+    case JOURNAL_RECORD_MATERIAL: {
+      const JournalMaterial& record = *ReadRecord<JournalMaterial>(data, m_path);
+
+      std::shared_ptr<Material>& material = m_materials[record.id];
+      if(!material) {
+        material = std::make_shared<Material>();
+      } else {
+        material->MarkAsDirty();
+      }
+      material->m_diffuse_map = GetResource(m_textures, record.diffuse_map);
+      break;
+    }
+    case JOURNAL_RECORD_TEXTURE: {
+      const JournalTexture& record = *ReadRecord<JournalTexture>(data, m_path);
+
+      std::shared_ptr<Texture2D>& texture = m_textures[record.id];
+      if(!texture) {
+        texture = std::make_shared<Texture2D>(
+          record.width,
+          record.height,
+          (Texture2D::Format)record.format,
+          (Texture2D::DataType)record.data_type,
+          (Texture2D::ColorSpace)record.color_space
+        );
+      } else {
+        texture->MarkAsDirty();
+      }
+
+      if(record.data_size != texture->Size()) {
+        ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+      }
+      std::memcpy(texture->Data(), ReadRecord<u8>(data, m_path, sizeof(JournalTexture), texture->Size()), texture->Size());
+      break;
+    }
+    case JOURNAL_RECORD_PREFAB: {
+      const JournalPrefab& record = *ReadRecord<JournalPrefab>(data, m_path);
+      const JournalPrefabMesh* journal_meshes = ReadRecord<JournalPrefabMesh>(data, m_path, sizeof(JournalPrefab), record.number_of_meshes);
+
+      std::vector<Prefab::Mesh> meshes{};
+      meshes.reserve(record.number_of_meshes);
+
+      for(u32 i = 0; i < record.number_of_meshes; i++) {
+        Prefab::Mesh& mesh = meshes.emplace_back();
+        mesh.geometry = GetResource(m_geometries, journal_meshes[i].geometry);
+        mesh.material = GetResource(m_materials, journal_meshes[i].material);
+        std::memcpy(&mesh.local_to_prefab, journal_meshes[i].local_to_prefab, sizeof(mesh.local_to_prefab));
+      }
+
+      m_prefabs[record.id] = std::make_shared<const Prefab>(std::move(meshes));
+      break;
+    }
+    case JOURNAL_RECORD_NODE_MOUNTED: {
+      const JournalNode& record = *ReadRecord<JournalNode>(data, m_path);
+      const char* name = ReadRecord<char>(data, m_path, sizeof(JournalNode), record.name_length);
+      const bool is_static = record.flags & JOURNAL_NODE_FLAG_STATIC;
+
+      SceneNode* node = GetNode(record.node);
+
+      // The recorded root node is the first node to be mounted and takes the place of the root node of our scene graph.
+      if(!node && record.parent == k_no_node) {
+        node = m_scene_graph->GetRoot();
+        m_nodes[record.node] = node;
+        m_recorded_handles[node] = record.node;
+      }
+
+      if(node) {
+        // The node was hidden or is remounted because its static flag changed. Static nodes must be unfrozen to update their transform.
+        if(node->IsStatic() && !is_static) {
+          node->SetStatic(false);
+        }
+        if(!node->IsStatic()) {
+          ApplyTransform(node, record.transform);
+        }
+        ApplyComponents(node, record);
+        if(is_static && !node->IsStatic()) {
+          node->SetStatic(true);
+        }
+        node->SetVisible(true);
+        break;
+      }
+
+      SceneNode* parent_node = GetNode(record.parent);
+
+      if(!parent_node) {
+        ZEPHYR_PANIC("Scene journal is corrupt: {}", m_path.string());
+      }
+
+      // Set up the node completely before mounting it, so that mounting it only yields a single NodeMounted patch.
+      std::shared_ptr<SceneNode> new_node = SceneNode::New(std::string{name, record.name_length});
+      ApplyTransform(new_node.get(), record.transform);
+      ApplyComponents(new_node.get(), record);
+      if(is_static) {
+        new_node->SetStatic(true);
+      }
+
+      m_nodes[record.node] = new_node.get();
+      m_recorded_handles[new_node.get()] = record.node;
+      parent_node->Add(std::move(new_node));
+      break;
+    }
+    case JOURNAL_RECORD_NODE_REMOVED:
+    case JOURNAL_RECORD_NODE_HIDDEN: {
+      ReplayNodeRemoved(ReadRecord<JournalNodeHandle>(data, m_path)->node, type == JOURNAL_RECORD_NODE_HIDDEN);
+      break;
+    }
+    case JOURNAL_RECORD_NODE_COMPONENTS_CHANGED: {
+      const JournalNode& record = *ReadRecord<JournalNode>(data, m_path);
+
+      if(SceneNode* node = GetNode(record.node); node) {
+        ApplyComponents(node, record);
+      }
+      break;
+    }
+    case JOURNAL_RECORD_NODE_TRANSFORM_CHANGED: {
+      const JournalNodeTransform& record = *ReadRecord<JournalNodeTransform>(data, m_path);
+
+      // Journals may still contain records for static nodes, which cannot have their transform updated.
+      if(SceneNode* node = GetNode(record.node); node && !node->IsStatic()) {
+        ApplyTransform(node, record.transform);
+      }
+      break;
+    }
+    default: {
+      ZEPHYR_PANIC("Scene journal contains a record of unknown type {}: {}", type, m_path.string());
+    }
+  }
+}
+
+void SceneJournalPlayer::ReplayNodeRemoved(u64 recorded_handle, bool hidden) {
+  SceneNode* node = GetNode(recorded_handle);
+
+  // The node may have been removed already together with one of its ancestors.
+  if(!node) {
+    return;
+  }
+
+  if(hidden) {
+    // The recorder reports each node of a hidden subtree individually, so hiding each node is enough to reproduce the patches.
+    node->SetVisible(false);
+    return;
+  }
+
+  // Forget about the entire subtree, since it is destroyed together with the node.
+  node->Traverse([&](const SceneNode* child_node) {
+    const auto match = m_recorded_handles.find(child_node);
+    if(match != m_recorded_handles.end()) {
+      m_nodes.erase(match->second);
+      m_recorded_handles.erase(match);
+    }
+    return true;
+  });
+
+  node->RemoveFromParent();
+}
+
+} // namespace zephyr
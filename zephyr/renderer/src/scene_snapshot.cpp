@@ -0,0 +1,393 @@
+#include <zephyr/renderer/component/mesh.hpp>
+#include <zephyr/renderer/scene_snapshot.hpp>
+#include <zephyr/mapped_file.hpp>
+#include <zephyr/panic.hpp>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace zephyr {
+
+namespace {
+
+constexpr char k_snapshot_magic[8] = {'Z', 'S', 'N', 'A', 'P', 'S', 'H', 'T'};
+constexpr u32 k_snapshot_version = 1u;
+constexpr u32 k_no_index = ~0u;
+constexpr u64 k_payload_alignment = 16u;
+
+enum SnapshotNodeFlag : u32 {
+  SNAPSHOT_NODE_FLAG_VISIBLE = 1u << 0,
+  SNAPSHOT_NODE_FLAG_STATIC = 1u << 1
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  u32 version;
+  u32 number_of_nodes;
+  u32 number_of_geometries;
+  u32 number_of_materials;
+  u32 number_of_textures;
+  u32 reserved;
+  u64 nodes_offset;
+  u64 geometries_offset;
+  u64 materials_offset;
+  u64 textures_offset;
+  u64 file_size;
+};
+
+struct SnapshotNode {
+  u32 parent; //< Index of the parent node, which always precedes the node, or k_no_index for the root
+  u32 flags;
+  u64 name_offset;
+  u64 name_length;
+  f32 position[3];
+  f32 rotation[4]; //< W, X, Y, Z
+  f32 scale[3];
+  u32 geometry; //< Index of the mesh geometry or k_no_index if the node has no mesh
+  u32 material; //< Index of the mesh material or k_no_index if the mesh has no material
+};
+
+struct SnapshotGeometry {
+  u32 layout_key;
+  u32 reserved;
+  u64 number_of_vertices;
+  u64 number_of_indices;
+  u64 vertex_data_offset;
+  u64 index_data_offset;
+};
+
+struct SnapshotMaterial {
+  u32 diffuse_map; //< Index of the texture or k_no_index
+};
+
+struct SnapshotTexture {
+  u32 width;
+  u32 height;
+  u32 format;
+  u32 data_type;
+  u32 color_space;
+  u32 reserved;
+  u64 data_offset;
+  u64 data_size;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader> && std::is_trivially_copyable_v<SnapshotNode>);
+static_assert(std::is_trivially_copyable_v<SnapshotGeometry> && std::is_trivially_copyable_v<SnapshotMaterial> && std::is_trivially_copyable_v<SnapshotTexture>);
+
+u64 AlignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+} // anonymous namespace
+
+void SaveSceneSnapshot(const SceneNode* root, const std::filesystem::path& path) {
+  std::vector<SnapshotNode> nodes{};
+  std::vector<SnapshotGeometry> geometries{};
+  std::vector<SnapshotMaterial> materials{};
+  std::vector<SnapshotTexture> textures{};
+
+  std::unordered_map<const SceneNode*, u32> node_indices{};
+  std::unordered_map<const Geometry*, u32> geometry_indices{};
+  std::unordered_map<const Material*, u32> material_indices{};
+  std::unordered_map<const Texture2D*, u32> texture_indices{};
+
+  // Names and resource payloads are collected in a separate section. Offsets are relative to that section until the file layout is known.
+  std::vector<u8> payload{};
+
+  const auto AppendPayload = [&](const void* data, size_t size) -> u64 {
+    const u64 offset = AlignUp(payload.size(), k_payload_alignment);
+    payload.resize(offset + size);
+    if(size > 0u) {
+      std::memcpy(payload.data() + offset, data, size);
+    }
+    return offset;
+  };
+
+  const auto GetTextureIndex = [&](const Texture2D* texture) -> u32 {
+    if(!texture) {
+      return k_no_index;
+    }
+
+    const auto [match, inserted] = texture_indices.try_emplace(texture, (u32)textures.size());
+    if(inserted) {
+      textures.push_back({
+        .width = texture->GetWidth(),
+        .height = texture->GetHeight(),
+        .format = (u32)texture->GetFormat(),
+        .data_type = (u32)texture->GetDataType(),
+        .color_space = (u32)texture->GetColorSpace(),
+        .reserved = 0u,
+        .data_offset = AppendPayload(texture->Data(), texture->Size()),
+        .data_size = texture->Size()
+      });
+    }
+    return match->second;
+  };
+
+  const auto GetMaterialIndex = [&](const Material* material) -> u32 {
+    if(!material) {
+      return k_no_index;
+    }
+
+    const auto [match, inserted] = material_indices.try_emplace(material, (u32)materials.size());
+    if(inserted) {
+      // Resolve the texture first, since it may append to the payload section.
+      const u32 diffuse_map = GetTextureIndex(material->m_diffuse_map.get());
+      materials.push_back({.diffuse_map = diffuse_map});
+    }
+    return match->second;
+  };
+
+  const auto GetGeometryIndex = [&](const Geometry* geometry) -> u32 {
+    if(!geometry) {
+      return k_no_index;
+    }
+
+    const auto [match, inserted] = geometry_indices.try_emplace(geometry, (u32)geometries.size());
+    if(inserted) {
+      const std::span<const u8> vertex_data = geometry->GetRawVertexData();
+      const std::span<const u8> index_data = geometry->GetRawIndexData();
+
+      geometries.push_back({
+        .layout_key = geometry->GetLayout().key,
+        .reserved = 0u,
+        .number_of_vertices = geometry->GetNumberOfVertices(),
+        .number_of_indices = geometry->GetNumberOfIndices(),
+        .vertex_data_offset = AppendPayload(vertex_data.data(), vertex_data.size()),
+        .index_data_offset = AppendPayload(index_data.data(), index_data.size())
+      });
+    }
+    return match->second;
+  };
+
+  // Nodes are stored in pre-order, so that the parent of each node is created before the node itself when loading the snapshot.
+  root->Traverse([&](const SceneNode* node) {
+    const Transform3D& transform = node->GetTransform();
+    const Vector3& position = transform.GetPosition();
+    const Quaternion& rotation = transform.GetRotation();
+    const Vector3& scale = transform.GetScale();
+
+    SnapshotNode& snapshot_node = nodes.emplace_back();
+    snapshot_node.parent = node == root ? k_no_index : node_indices[node->GetParent()];
+    snapshot_node.flags = (node->IsVisible() ? SNAPSHOT_NODE_FLAG_VISIBLE : 0u) | (node->IsStatic() ? SNAPSHOT_NODE_FLAG_STATIC : 0u);
+    snapshot_node.name_offset = AppendPayload(node->GetName().data(), node->GetName().size());
+    snapshot_node.name_length = node->GetName().size();
+    snapshot_node.position[0] = position.X();
+    snapshot_node.position[1] = position.Y();
+    snapshot_node.position[2] = position.Z();
+    snapshot_node.rotation[0] = rotation.W();
+    snapshot_node.rotation[1] = rotation.X();
+    snapshot_node.rotation[2] = rotation.Y();
+    snapshot_node.rotation[3] = rotation.Z();
+    snapshot_node.scale[0] = scale.X();
+    snapshot_node.scale[1] = scale.Y();
+    snapshot_node.scale[2] = scale.Z();
+    snapshot_node.geometry = k_no_index;
+    snapshot_node.material = k_no_index;
+
+    if(node->HasComponent<MeshComponent>()) {
+      const MeshComponent& mesh_component = node->GetComponent<MeshComponent>();
+      snapshot_node.geometry = GetGeometryIndex(mesh_component.geometry.get());
+      snapshot_node.material = GetMaterialIndex(mesh_component.material.get());
+    }
+
+    node_indices[node] = (u32)nodes.size() - 1u;
+    return true;
+  });
+
+  // File layout: the header, the node, geometry, material and texture tables and finally the payload section.
+  SnapshotHeader header{};
+  std::memcpy(header.magic, k_snapshot_magic, sizeof(header.magic));
+  header.version = k_snapshot_version;
+  header.number_of_nodes = (u32)nodes.size();
+  header.number_of_geometries = (u32)geometries.size();
+  header.number_of_materials = (u32)materials.size();
+  header.number_of_textures = (u32)textures.size();
+  header.nodes_offset = AlignUp(sizeof(SnapshotHeader), k_payload_alignment);
+  header.geometries_offset = AlignUp(header.nodes_offset + nodes.size() * sizeof(SnapshotNode), k_payload_alignment);
+  header.materials_offset = AlignUp(header.geometries_offset + geometries.size() * sizeof(SnapshotGeometry), k_payload_alignment);
+  header.textures_offset = AlignUp(header.materials_offset + materials.size() * sizeof(SnapshotMaterial), k_payload_alignment);
+
+  const u64 payload_offset = AlignUp(header.textures_offset + textures.size() * sizeof(SnapshotTexture), k_payload_alignment);
+  header.file_size = payload_offset + payload.size();
+
+  for(SnapshotNode& snapshot_node : nodes) {
+    snapshot_node.name_offset += payload_offset;
+  }
+
+  for(SnapshotGeometry& snapshot_geometry : geometries) {
+    snapshot_geometry.vertex_data_offset += payload_offset;
+    snapshot_geometry.index_data_offset += payload_offset;
+  }
+
+  for(SnapshotTexture& snapshot_texture : textures) {
+    snapshot_texture.data_offset += payload_offset;
+  }
+
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  if(!file.good()) {
+    ZEPHYR_PANIC("Failed to open scene snapshot for writing: {}", path.string());
+  }
+
+  const auto Write = [&](u64 offset, const void* data, size_t size) {
+    // Zero-fill the alignment padding up to the requested offset.
+    static constexpr char padding[k_payload_alignment]{};
+    file.write(padding, (std::streamsize)(offset - (u64)file.tellp()));
+    file.write((const char*)data, (std::streamsize)size);
+  };
+
+  Write(0u, &header, sizeof(header));
+  Write(header.nodes_offset, nodes.data(), nodes.size() * sizeof(SnapshotNode));
+  Write(header.geometries_offset, geometries.data(), geometries.size() * sizeof(SnapshotGeometry));
+  Write(header.materials_offset, materials.data(), materials.size() * sizeof(SnapshotMaterial));
+  Write(header.textures_offset, textures.data(), textures.size() * sizeof(SnapshotTexture));
+  Write(payload_offset, payload.data(), payload.size());
+
+  if(!file.good()) {
+    ZEPHYR_PANIC("Failed to write scene snapshot: {}", path.string());
+  }
+}
+
+std::shared_ptr<SceneNode> LoadSceneSnapshot(const std::filesystem::path& path) {
+  const MappedFile file{path};
+  const std::span<const u8> data = file.GetData();
+
+  if(data.size() < sizeof(SnapshotHeader)) {
+    ZEPHYR_PANIC("Scene snapshot is truncated: {}", path.string());
+  }
+
+  const SnapshotHeader& header = *(const SnapshotHeader*)data.data();
+
+  if(std::memcmp(header.magic, k_snapshot_magic, sizeof(header.magic)) != 0 || header.version != k_snapshot_version) {
+    ZEPHYR_PANIC("File is not a scene snapshot or has an unsupported version: {}", path.string());
+  }
+
+  if(header.file_size != data.size() || header.number_of_nodes == 0u) {
+    ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+  }
+
+  // All offsets are validated against the file size before they are used. Tables are aligned, so records can be read in place.
+  const auto GetRange = [&](u64 offset, u64 size) -> const u8* {
+    if(offset > data.size() || size > data.size() - offset) {
+      ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+    }
+    return data.data() + offset;
+  };
+
+  const auto* snapshot_nodes = (const SnapshotNode*)GetRange(header.nodes_offset, (u64)header.number_of_nodes * sizeof(SnapshotNode));
+  const auto* snapshot_geometries = (const SnapshotGeometry*)GetRange(header.geometries_offset, (u64)header.number_of_geometries * sizeof(SnapshotGeometry));
+  const auto* snapshot_materials = (const SnapshotMaterial*)GetRange(header.materials_offset, (u64)header.number_of_materials * sizeof(SnapshotMaterial));
+  const auto* snapshot_textures = (const SnapshotTexture*)GetRange(header.textures_offset, (u64)header.number_of_textures * sizeof(SnapshotTexture));
+
+  std::vector<std::shared_ptr<Texture2D>> textures{};
+  textures.reserve(header.number_of_textures);
+
+  for(u32 i = 0; i < header.number_of_textures; i++) {
+    const SnapshotTexture& snapshot_texture = snapshot_textures[i];
+
+    std::shared_ptr<Texture2D>& texture = textures.emplace_back(std::make_shared<Texture2D>(
+      snapshot_texture.width,
+      snapshot_texture.height,
+      (Texture2D::Format)snapshot_texture.format,
+      (Texture2D::DataType)snapshot_texture.data_type,
+      (Texture2D::ColorSpace)snapshot_texture.color_space
+    ));
+
+    if(snapshot_texture.data_size != texture->Size()) {
+      ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+    }
+    std::memcpy(texture->Data(), GetRange(snapshot_texture.data_offset, snapshot_texture.data_size), snapshot_texture.data_size);
+  }
+
+  const auto GetTexture = [&](u32 index) -> std::shared_ptr<Texture2D> {
+    if(index == k_no_index) {
+      return nullptr;
+    }
+    if(index >= textures.size()) {
+      ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+    }
+    return textures[index];
+  };
+
+  std::vector<std::shared_ptr<Material>> materials{};
+  materials.reserve(header.number_of_materials);
+
+  for(u32 i = 0; i < header.number_of_materials; i++) {
+    std::shared_ptr<Material>& material = materials.emplace_back(std::make_shared<Material>());
+    material->m_diffuse_map = GetTexture(snapshot_materials[i].diffuse_map);
+  }
+
+  std::vector<std::shared_ptr<Geometry>> geometries{};
+  geometries.reserve(header.number_of_geometries);
+
+  for(u32 i = 0; i < header.number_of_geometries; i++) {
+    const SnapshotGeometry& snapshot_geometry = snapshot_geometries[i];
+
+    std::shared_ptr<Geometry>& geometry = geometries.emplace_back(std::make_shared<Geometry>(
+      RenderGeometryLayout{snapshot_geometry.layout_key},
+      (size_t)snapshot_geometry.number_of_vertices,
+      (size_t)snapshot_geometry.number_of_indices
+    ));
+
+    const std::span<u8> vertex_data = geometry->GetRawVertexData();
+    const std::span<u8> index_data = geometry->GetRawIndexData();
+
+    // Empty buffers, i.e. the index buffer of a non-indexed geometry, may have no storage at all, which must not be passed to memcpy().
+    if(!vertex_data.empty()) {
+      std::memcpy(vertex_data.data(), GetRange(snapshot_geometry.vertex_data_offset, vertex_data.size()), vertex_data.size());
+    }
+    if(!index_data.empty()) {
+      std::memcpy(index_data.data(), GetRange(snapshot_geometry.index_data_offset, index_data.size()), index_data.size());
+    }
+  }
+
+  const auto GetResource = [&](const auto& resources, u32 index) {
+    if(index == k_no_index) {
+      return std::remove_cvref_t<decltype(resources[0])>{};
+    }
+    if(index >= resources.size()) {
+      ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+    }
+    return resources[index];
+  };
+
+  // Construct all nodes in pre-order and link each node to its already constructed parent. The subtree is not mounted yet,
+  // so linking does not involve any scene graph work. Static flags are applied last, since they freeze the transforms.
+  std::vector<std::shared_ptr<SceneNode>> nodes{};
+  nodes.reserve(header.number_of_nodes);
+
+  for(u32 i = 0; i < header.number_of_nodes; i++) {
+    const SnapshotNode& snapshot_node = snapshot_nodes[i];
+
+    if((i == 0u) != (snapshot_node.parent == k_no_index) || (i > 0u && snapshot_node.parent >= i)) {
+      ZEPHYR_PANIC("Scene snapshot is corrupt: {}", path.string());
+    }
+
+    const char* name = (const char*)GetRange(snapshot_node.name_offset, snapshot_node.name_length);
+    std::shared_ptr<SceneNode>& node = nodes.emplace_back(SceneNode::New(std::string{name, (size_t)snapshot_node.name_length}));
+
+    Transform3D& transform = node->GetTransform();
+    transform.SetPosition({snapshot_node.position[0], snapshot_node.position[1], snapshot_node.position[2]});
+    transform.SetRotation({snapshot_node.rotation[0], snapshot_node.rotation[1], snapshot_node.rotation[2], snapshot_node.rotation[3]});
+    transform.SetScale({snapshot_node.scale[0], snapshot_node.scale[1], snapshot_node.scale[2]});
+    node->SetVisible(snapshot_node.flags & SNAPSHOT_NODE_FLAG_VISIBLE);
+
+    if(snapshot_node.geometry != k_no_index) {
+      node->CreateComponent<MeshComponent>(GetResource(geometries, snapshot_node.geometry), GetResource(materials, snapshot_node.material));
+    }
+
+    if(snapshot_node.flags & SNAPSHOT_NODE_FLAG_STATIC) {
+      node->SetStatic(true);
+    }
+
+    if(i > 0u) {
+      nodes[snapshot_node.parent]->Add(node);
+    }
+  }
+
+  return nodes[0];
+}
+
+} // namespace zephyr
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <zephyr/math/quaternion.hpp>
+#include <zephyr/math/vector.hpp>
+#include <zephyr/scene/scene_graph.hpp>
+#include <zephyr/float.hpp>
+#include <zephyr/integer.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace zephyr {
+
+class SceneNode;
+
+/**
+ * A set of keyframe tracks, each of which animates the position, rotation or scale of one of the clip's targets.
+ * Targets are plain indices, which are mapped to scene nodes when the clip is played, so that one clip can animate any number of characters.
+ * The keyframes of all tracks are stored in a few shared arrays, rather than in one allocation per track.
+ */
+class AnimationClip {
+  public:
+    enum class Channel : u8 {
+      Position,
+      Rotation,
+      Scale
+    };
+
+    enum class Interpolation : u8 {
+      Step,
+      Linear, //< Linear interpolation of positions and scales, normalized linear interpolation of rotations
+      Spherical //< Spherical linear interpolation of rotations, same as Linear for positions and scales
+    };
+
+    struct Track {
+      u32 target;
+      Channel channel;
+      Interpolation interpolation;
+      u32 first_key; //< Index of the first key time
+      u32 first_value; //< Index of the first key value, in the vector or rotation keys depending on the channel
+      u32 number_of_keys;
+    };
+
+    /**
+     * Add a track animating the position or scale of a target. The key times must be in ascending order.
+     * @returns the index of the track.
+     */
+    u32 AddTrack(u32 target, Channel channel, Interpolation interpolation, std::span<const f32> key_times, std::span<const Vector3> key_values);
+
+    /**
+     * Add a track animating the rotation of a target. The key times must be in ascending order.
+     * @returns the index of the track.
+     */
+    u32 AddTrack(u32 target, Interpolation interpolation, std::span<const f32> key_times, std::span<const Quaternion> key_values);
+
+    [[nodiscard]] std::span<const Track> GetTracks() const {
+      return m_tracks;
+    }
+
+    [[nodiscard]] std::span<const f32> GetKeyTimes() const {
+      return m_key_times;
+    }
+
+    /// @returns the keyframe values of all position and scale tracks.
+    [[nodiscard]] std::span<const Vector3> GetVectorKeys() const {
+      return m_vector_keys;
+    }
+
+    /// @returns the keyframe values of all rotation tracks.
+    [[nodiscard]] std::span<const Quaternion> GetRotationKeys() const {
+      return m_rotation_keys;
+    }
+
+    /// @returns the number of targets, which is one more than the highest target index of all tracks.
+    [[nodiscard]] u32 GetNumberOfTargets() const {
+      return m_number_of_targets;
+    }
+
+    /// @returns the time of the last keyframe of all tracks.
+    [[nodiscard]] f32 GetDuration() const {
+      return m_duration;
+    }
+
+  private:
+    u32 AddTrackKeys(u32 target, Channel channel, Interpolation interpolation, std::span<const f32> key_times, u32 first_value);
+
+    std::vector<Track> m_tracks{};
+    std::vector<f32> m_key_times{};
+    std::vector<Vector3> m_vector_keys{};
+    std::vector<Quaternion> m_rotation_keys{};
+    u32 m_number_of_targets{};
+    f32 m_duration{};
+};
+
+/**
+ * Plays animation clips on many groups of nodes at once, i.e. on the skeletons of a crowd of characters.
+ *
+ * Each update first gathers the keyframe pairs of all tracks of all playing clips into flat structure-of-arrays buffers, one per channel type.
+ * The interpolation then runs as a few tight loops over these buffers, which the compiler turns into SIMD code, instead of one call per track.
+ * Finally, the results are written straight into the transform storage of the scene graph via SceneGraph::WritePositions() and friends,
+ * which flags each animated node dirty only once.
+ */
+class AnimationSystem {
+  public:
+    using AnimationID = u32;
+
+    /**
+     * Start playing a clip on a set of mounted nodes. The clip's target indices refer to the entries of the targets span.
+     * Nodes which are removed from the scene graph while the clip plays are skipped.
+     * @param start_time the time into the clip to start playing from, i.e. to desynchronize the members of a crowd
+     * @param loop whether to play the clip in a loop, otherwise it stops automatically after applying its final pose
+     * @returns an ID for the playing clip, which becomes invalid once the clip stopped.
+     */
+    AnimationID Play(std::shared_ptr<const AnimationClip> clip, std::span<SceneNode* const> targets, f32 start_time = 0.0f, bool loop = true);
+
+    /// Stop playing a clip. The animated nodes keep their current transforms.
+    void Stop(AnimationID id);
+
+    /// @returns whether the clip with the given ID is still playing.
+    [[nodiscard]] bool IsPlaying(AnimationID id) const;
+
+    /// Advance all playing clips by a time step, sample their tracks and write the results to the scene graph.
+    void Update(SceneGraph& scene_graph, f32 delta_time);
+
+  private:
+    struct Animation {
+      std::shared_ptr<const AnimationClip> clip;
+      std::vector<SceneNodeHandle> targets;
+      std::vector<u32> key_cursors; //< The last sampled keyframe of each track, which makes finding the next keyframe O(1) in the common case
+      f32 time;
+      bool loop;
+      bool playing;
+    };
+
+    /// Pairs of keyframes and interpolation factors of one channel type in structure-of-arrays layout, together with the target nodes.
+    template<int number_of_lanes>
+    struct SampleBuffer {
+      void Clear() {
+        for(int lane = 0; lane < number_of_lanes; lane++) {
+          a[lane].clear();
+          b[lane].clear();
+        }
+        t.clear();
+        nodes.clear();
+      }
+
+      std::vector<f32> a[number_of_lanes];
+      std::vector<f32> b[number_of_lanes];
+      std::vector<f32> t;
+      std::vector<SceneNodeHandle> nodes;
+    };
+
+    static u32 FindKey(std::span<const f32> key_times, u32 cursor, f32 time);
+    static void LerpVectors(const SampleBuffer<3>& samples, std::vector<Vector3>& results);
+    static void NLerpRotations(const SampleBuffer<4>& samples, std::vector<Quaternion>& results);
+    static void SLerpRotations(const SampleBuffer<4>& samples, std::vector<Quaternion>& results);
+
+    void GatherSamples(Animation& animation);
+
+    std::vector<Animation> m_animations{};
+    std::vector<AnimationID> m_free_animation_ids{};
+
+    SampleBuffer<3> m_position_samples{};
+    SampleBuffer<3> m_scale_samples{};
+    SampleBuffer<4> m_nlerp_samples{};
+    SampleBuffer<4> m_slerp_samples{};
+
+    std::vector<Vector3> m_vector_results{};
+    std::vector<Quaternion> m_rotation_results{};
+};
+
+} // namespace zephyr
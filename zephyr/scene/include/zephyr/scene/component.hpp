@@ -1,13 +1,48 @@
-
 #pragma once
 
+#include <zephyr/math/box3.hpp>
+#include <zephyr/scene/component_pool.hpp>
+#include <zephyr/integer.hpp>
 #include <zephyr/non_copyable.hpp>
 #include <zephyr/non_moveable.hpp>
+#include <typeinfo>
 
 namespace zephyr {
 
 struct Component : NonCopyable, NonMoveable {
   virtual ~Component() = default;
+
+  /// @returns the bounds of the component's content in the local space of its node, which the scene graph uses to compute subtree bounds.
+  [[nodiscard]] virtual Box3 GetLocalBounds() const {
+    return Box3::Empty();
+  }
+};
+
+using ComponentTypeID = u32;
+
+/**
+ * Assigns a small integer ID to each component type, which is used to index component bitmasks and to dispatch on component types.
+ * IDs are assigned on first use and remain stable for the lifetime of the process.
+ */
+class ComponentRegistry {
+  public:
+    using DestroyFunction = void (*)(Component*);
+
+    static constexpr size_t k_max_number_of_types = 64u;
+
+    template<typename T>
+    [[nodiscard]] static ComponentTypeID GetTypeID() {
+      static const ComponentTypeID type_id = RegisterType(typeid(T).name(), [](Component* component) {
+        ComponentPool<T>::Get().Destroy((T*)component);
+      });
+      return type_id;
+    }
+
+    /// Destroy a component given only its type ID, returning its memory to the pool of the type.
+    static void DestroyComponent(ComponentTypeID type_id, Component* component);
+
+  private:
+    static ComponentTypeID RegisterType(const char* type_name, DestroyFunction destroy_function);
 };
 
 } // namespace zephyr
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <zephyr/integer.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace zephyr {
+
+class SceneNode;
+
+/**
+ * Process-wide storage for all components of a single type.
+ *
+ * Components are constructed in place inside fixed-size chunks, which keeps their addresses stable for their entire lifetime
+ * and avoids a heap allocation per component. Additionally the pool keeps a dense array of all live components and their owning nodes,
+ * so that all components of a type can be iterated without traversing the scene graph.
+ *
+ * Components are created and destroyed by the nodes owning them, so the pool is not thread-safe, just like the nodes themselves.
+ */
+template<typename T>
+class ComponentPool : NonCopyable, NonMoveable {
+  public:
+    [[nodiscard]] static ComponentPool& Get() {
+      static ComponentPool pool{};
+      return pool;
+    }
+
+    template<typename... Args>
+    T* Create(SceneNode* node, Args&&... args) {
+      if(m_free_slots.empty()) {
+        AllocateChunk();
+      }
+
+      Slot* slot = m_free_slots.back();
+      T* component = new(slot->storage) T(std::forward<Args>(args)...);
+      m_free_slots.pop_back();
+
+      slot->dense_index = (u32)m_components.size();
+      m_components.push_back(component);
+      m_nodes.push_back(node);
+      return component;
+    }
+
+    void Destroy(T* component) {
+      Slot* slot = GetSlot(component);
+      const u32 dense_index = slot->dense_index;
+
+      component->~T();
+
+      // Swap-and-pop the component from the dense arrays.
+      T* last_component = m_components.back();
+      m_components[dense_index] = last_component;
+      m_nodes[dense_index] = m_nodes.back();
+      GetSlot(last_component)->dense_index = dense_index;
+      m_components.pop_back();
+      m_nodes.pop_back();
+
+      m_free_slots.push_back(slot);
+    }
+
+    /// @returns all live components of the type, in no particular order.
+    [[nodiscard]] std::span<T* const> GetComponents() const {
+      return m_components;
+    }
+
+    /// @returns the nodes owning the components returned by GetComponents(), in the same order.
+    [[nodiscard]] std::span<SceneNode* const> GetNodes() const {
+      return m_nodes;
+    }
+
+  private:
+    static constexpr size_t k_slots_per_chunk = 256u;
+
+    struct Slot {
+      u32 dense_index;
+      alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    ComponentPool() = default;
+
+    static Slot* GetSlot(T* component) {
+      return reinterpret_cast<Slot*>(reinterpret_cast<std::byte*>(component) - offsetof(Slot, storage));
+    }
+
+    void AllocateChunk() {
+      std::unique_ptr<Slot[]>& chunk = m_chunks.emplace_back(std::make_unique_for_overwrite<Slot[]>(k_slots_per_chunk));
+
+      // Push the slots in reverse, so that they are handed out in address order.
+      for(size_t i = k_slots_per_chunk; i > 0u; i--) {
+        m_free_slots.push_back(&chunk[i - 1u]);
+      }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_chunks{};
+    std::vector<Slot*> m_free_slots{};
+    std::vector<T*> m_components{}; //< Dense array of all live components
+    std::vector<SceneNode*> m_nodes{}; //< The node owning each component in m_components
+};
+
+} // namespace zephyr
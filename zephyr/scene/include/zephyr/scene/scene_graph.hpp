@@ -1,17 +1,42 @@
 
 #pragma once
 
+#include <zephyr/scene/component.hpp>
+#include <zephyr/scene/transform_storage.hpp>
 #include <zephyr/integer.hpp>
-#include <EASTL/hash_map.h>
+#include <zephyr/interned_string.hpp>
+#include <zephyr/non_copyable.hpp>
+#include <zephyr/non_moveable.hpp>
+#include <zephyr/thread_pool.hpp>
 #include <memory>
 #include <span>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <typeindex>
 
 namespace zephyr {
 
 class SceneNode;
 
+/**
+ * A lightweight reference to a node that is mounted to a scene graph.
+ * The handle becomes stale once the node is removed from the scene graph, which can be detected via SceneGraph::GetNode().
+ */
+struct SceneNodeHandle {
+  static constexpr u32 k_invalid_index = ~0u;
+
+  [[nodiscard]] bool IsValid() const {
+    return index != k_invalid_index;
+  }
+
+  [[nodiscard]] bool operator==(const SceneNodeHandle& other) const {
+    return index == other.index && generation == other.generation;
+  }
+
+  u32 index{k_invalid_index};
+  u32 generation{};
+};
+
 struct ScenePatch {
   enum class Type : u8 {
     NodeMounted,
@@ -22,13 +47,14 @@ struct ScenePatch {
   };
 
   Type type;
-  std::shared_ptr<SceneNode> node;
-  std::type_index component_type{typeid(void)};
+  SceneNodeHandle node;
+  ComponentTypeID component_type{};
 };
 
-class SceneGraph {
+class SceneGraph : NonCopyable, NonMoveable {
   public:
     SceneGraph();
+   ~SceneGraph();
 
     [[nodiscard]] const SceneNode* GetRoot() const {
       return m_root_node.get();
@@ -38,33 +64,213 @@ class SceneGraph {
       return m_root_node.get();
     }
 
-    void ClearScenePatches() {
-      m_scene_patches.clear();
+    /// @returns the node referenced by a handle or nullptr if the handle is stale.
+    [[nodiscard]] SceneNode* GetNode(SceneNodeHandle handle) const {
+      if(handle.index >= m_node_table.size()) {
+        return nullptr;
+      }
+      const NodeTableEntry& entry = m_node_table[handle.index];
+      return entry.generation == handle.generation ? entry.node : nullptr;
     }
 
-    [[nodiscard]] std::span<ScenePatch const> GetScenePatches() {
-      return m_scene_patches;
-    }
+    /// @returns any one of the mounted nodes with the given name, or nullptr if there is none.
+    [[nodiscard]] SceneNode* FindNode(std::string_view name) const;
+
+    /// @returns all mounted nodes with the given name, in no particular order.
+    [[nodiscard]] std::span<SceneNode* const> FindNodes(std::string_view name) const;
+
+    /**
+     * Find a node by its path relative to the root node, which is made up of the names of the nodes along the way separated by slashes,
+     * i.e. "Level/Building/Door". An empty path refers to the root node. If multiple nodes match the path, any one of them is returned.
+     * The lookup costs one hash map lookup per path segment, unless siblings along the path share a name.
+     * @returns the node or nullptr if no node matches the path.
+     */
+    [[nodiscard]] SceneNode* FindNodeByPath(std::string_view path) const;
+
+    void ClearScenePatches();
+
+    /**
+     * @returns the patches describing the changes to the scene since the last call to ClearScenePatches().
+     * Patches are coalesced per node, i.e. mounting a node and changing its transform in the same frame only yields a NodeMounted patch,
+     * while mounting and then removing a node yields no patches at all. Every handle is valid, except for those of NodeRemoved patches.
+     */
+    [[nodiscard]] std::span<ScenePatch const> GetScenePatches();
+
+    /**
+     * Begin a batch of scene edits. While a batch is open, mounting nodes and changing the transforms of nodes mounted in the batch
+     * does not compute world visibility, dirty transforms or scene patches right away. Instead, this work is done once for all nodes
+     * mounted during the batch when the outermost batch is closed via EndBatch(). Batches may be nested.
+     * Transforms must not be updated while a batch is open.
+     */
+    void BeginBatch();
+
+    /// End a batch of scene edits, which was started with BeginBatch().
+    void EndBatch();
+
+    /**
+     * Overwrite the positions of many mounted nodes at once, i.e. with the results of sampling animations.
+     * The values are written straight into the transform storage and each node is flagged dirty at most once until the next transform update,
+     * no matter how many of its channels are written. Stale handles are skipped.
+     */
+    void WritePositions(std::span<const SceneNodeHandle> nodes, std::span<const Vector3> positions);
+
+    /// Overwrite the rotations of many mounted nodes at once. @see WritePositions()
+    void WriteRotations(std::span<const SceneNodeHandle> nodes, std::span<const Quaternion> rotations);
+
+    /// Overwrite the scales of many mounted nodes at once. @see WritePositions()
+    void WriteScales(std::span<const SceneNodeHandle> nodes, std::span<const Vector3> scales);
 
     void UpdateTransforms();
-    bool QueryNodeWorldVisibility(const SceneNode* node);
+
+    /**
+     * Update transforms like UpdateTransforms(), but update independent dirty subtrees in parallel.
+     * This pays off when many disjoint subtrees are dirty, i.e. crowds of animated characters.
+     */
+    void UpdateTransforms(ThreadPool& thread_pool);
+
+    /**
+     * Enable or disable lazy transform evaluation. While enabled, UpdateTransforms() only computes the matrices of nodes with components.
+     * The matrices of all other nodes, i.e. grouping nodes or the intermediate joints of a rig, are computed on demand
+     * when they are read via Transform3D::GetLocal() or Transform3D::GetWorld(). Disabled by default.
+     */
+    void SetLazyTransformEvaluation(bool enabled);
+
+    bool QueryNodeWorldVisibility(const SceneNode* node) const;
+
+    /**
+     * @returns the world-space bounds of a mounted node's components and its entire subtree, as of the last transform update.
+     * The bounds are empty if no node in the subtree has bounded components. Invisible nodes contribute to the bounds as well.
+     */
+    [[nodiscard]] const Box3& GetSubtreeBounds(const SceneNode* node) const;
+
+    /**
+     * @returns a snapshot of the world matrices of all mounted nodes as of the last transform update, indexed by SceneNodeHandle::index.
+     * Snapshots are double-buffered: each transform update writes into the buffer that was not written by the previous update.
+     * Thus another thread, i.e. the render thread, may keep reading a snapshot while the next frame is prepared, up until the transform update after that.
+     * Entries of nodes without components are not kept up-to-date while lazy transform evaluation is enabled. Entries of unused indices are undefined.
+     */
+    [[nodiscard]] std::span<const Matrix4> GetWorldMatrixSnapshot() const {
+      return m_world_matrix_snapshots[m_world_matrix_snapshot];
+    }
 
   private:
+    static constexpr size_t k_transform_update_jobs_per_thread = 4u;
+    static constexpr u32 k_no_scene_patch = ~0u;
+
+    struct NodeTableEntry {
+      SceneNode* node{};
+      u32 generation{};
+
+      // Patch coalescing state for the current frame:
+      u32 last_scene_patch{k_no_scene_patch}; //< The most recent live patch referencing the node
+      bool mounted_this_frame{}; //< Whether there is a live NodeMounted patch for the node
+      bool transform_patched{}; //< Whether there is a live NodeTransformChanged patch for the node
+
+      u32 name_index{}; //< The index of the node in its list in m_nodes_by_name
+    };
+
+    /// Identifies a child node by the node table index of its parent and its name.
+    struct ChildKey {
+      [[nodiscard]] bool operator==(const ChildKey& other) const = default;
+
+      u32 parent_index;
+      InternedString name;
+    };
+
+    struct ChildKeyHash {
+      size_t operator()(const ChildKey& key) const;
+    };
+
     friend SceneNode;
     friend class Transform3D;
 
     void SignalNodeMounted(SceneNode* node);
     void SignalNodeRemoved(SceneNode* node);
-    void SignalComponentMounted(SceneNode* node, std::type_index type_index);
-    void SignalComponentRemoved(SceneNode* node, std::type_index type_index);
+    void SignalComponentMounted(SceneNode* node, ComponentTypeID type_id);
+    void SignalComponentRemoved(SceneNode* node, ComponentTypeID type_id);
     void SignalNodeTransformChanged(SceneNode* node);
     void SignalNodeVisibilityChanged(SceneNode* node, bool visible);
+    void SignalNodeStaticChanged(SceneNode* node);
+    void SignalNodeLocalBoundsChanged(SceneNode* node);
+    void SignalNodeNameChanged(SceneNode* node, InternedString old_name);
+    void MarkSubtreeWorldVisible(SceneNode* node);
+    void MarkSubtreeWorldInvisible(SceneNode* node);
+
+    void PushScenePatch(ScenePatch::Type type, SceneNode* node, ComponentTypeID component_type = 0u);
+    void KillScenePatch(u32 patch_index);
+    void CompactScenePatches();
+
+    [[nodiscard]] bool IsSlotMountedInBatch(u32 slot) const {
+      return m_batch_depth > 0u && slot >= m_batch_first_slot;
+    }
+
+    template<typename T>
+    void WriteTransformChannel(std::vector<T> TransformStorage::* channel, std::span<const SceneNodeHandle> nodes, std::span<const T> values);
+
+    [[nodiscard]] SceneNode* FindNodeByPath(const SceneNode* parent_node, std::string_view path) const;
+    void AddToNameIndex(SceneNode* node, InternedString name, const SceneNode* parent_node);
+    void RemoveFromNameIndex(SceneNode* node, InternedString name, const SceneNode* parent_node, bool hand_over_to_sibling);
+
+    void BeginWorldMatrixSnapshot();
+    std::vector<SceneNode*>& CollectTransformUpdateJobs();
+    void EvaluateStaleJobParents(std::span<SceneNode* const> jobs);
+    bool UpdateTransformSlot(u32 slot, std::vector<u32>& snapshot_writes, std::vector<u32>& bounds_dirty_slots);
+    void MarkBoundsDirty(u32 slot);
+    void UpdateSubtreeBounds();
+    void RegisterSubtree(SceneNode* node);
+    void UnregisterSubtree(SceneNode* node);
+    void CompactTransformStorageIfNeeded();
+    void CompactTransformStorage();
 
     std::shared_ptr<SceneNode> m_root_node{};
-    std::vector<SceneNode*> m_pending_nodes_with_dirty_transforms{};
-    std::vector<SceneNode*> m_nodes_with_dirty_transform{};
-    eastl::hash_map<const SceneNode*, bool> m_node_world_visibility{}; //< Tracks the world visibility of nodes
+    std::vector<NodeTableEntry> m_node_table{};
+    std::vector<u32> m_free_node_table_indices{};
+    std::vector<u32> m_node_table_indices_to_free{}; //< Indices of removed nodes, which are not reused before the patches are cleared
+    std::unordered_map<InternedString, std::vector<SceneNode*>> m_nodes_by_name{};
+    std::unordered_map<ChildKey, SceneNode*, ChildKeyHash> m_child_by_name{}; //< Maps each name in use among the children of a node to one such child
+    TransformStorage m_transform_storage{};
+    std::vector<SceneNode*> m_dirty_transform_roots{}; //< Nodes whose transform changed since the last transform update
+    std::vector<u32> m_bounds_dirty_slots{}; //< The slots in the transform storage which have their bounds_dirty flag set
+    bool m_lazy_transform_evaluation{};
+
+    // Double-buffered world matrix snapshots, indexed by the node table index:
+    std::vector<Matrix4> m_world_matrix_snapshots[2]{};
+    std::vector<u32> m_world_matrix_snapshot_writes[2]{}; //< Node table indices written into each snapshot by the transform update which wrote it
+    u32 m_world_matrix_snapshot{}; //< The snapshot written by the last transform update
+
     std::vector<ScenePatch> m_scene_patches{};
+    std::vector<u32> m_previous_scene_patch_of_node{}; //< Links each live patch to the previous live patch of the same node
+    size_t m_number_of_dead_scene_patches{};
+
+    std::vector<SceneNode*> m_traversal_stack{};
+
+    u32 m_batch_depth{};
+    u32 m_batch_first_slot{}; //< The first transform slot allocated in the current batch
+
+    // Scratch buffers for parallel transform updates:
+    std::vector<SceneNode*> m_transform_update_jobs{};
+    std::vector<SceneNode*> m_transform_update_next_jobs{};
+    std::vector<std::vector<SceneNode*>> m_thread_local_transform_patches{};
+    std::vector<std::vector<u32>> m_thread_local_snapshot_writes{};
+    std::vector<std::vector<u32>> m_thread_local_bounds_dirty_slots{};
+};
+
+/**
+ * Keeps a batch of scene edits open for the lifetime of the object.
+ * @see SceneGraph::BeginBatch()
+ */
+class SceneGraphBatch : NonCopyable, NonMoveable {
+  public:
+    explicit SceneGraphBatch(SceneGraph& scene_graph) : m_scene_graph{scene_graph} {
+      m_scene_graph.BeginBatch();
+    }
+
+   ~SceneGraphBatch() {
+      m_scene_graph.EndBatch();
+    }
+
+  private:
+    SceneGraph& m_scene_graph;
 };
 
 } // namespace zephyr
@@ -4,15 +4,19 @@
 #include <zephyr/scene/component.hpp>
 #include <zephyr/scene/scene_graph.hpp>
 #include <zephyr/scene/transform.hpp>
+#include <zephyr/interned_string.hpp>
 #include <zephyr/non_copyable.hpp>
 #include <zephyr/non_moveable.hpp>
 #include <zephyr/panic.hpp>
+#include <zephyr/pool_allocator.hpp>
+#include <zephyr/thread_pool.hpp>
+#include <EASTL/fixed_vector.h>
 #include <algorithm>
+#include <bit>
 #include <memory>
 #include <span>
 #include <string>
-#include <typeindex>
-#include <unordered_map>
+#include <typeinfo>
 #include <vector>
 
 namespace zephyr {
@@ -22,7 +26,7 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
 
   public:
     explicit SceneNode(Private) {};
-    SceneNode(Private, std::string name, SceneGraph* scene_graph = nullptr) : m_name{std::move(name)}, m_scene_graph{scene_graph} {}
+    SceneNode(Private, InternedString name, SceneGraph* scene_graph = nullptr) : m_name{name}, m_scene_graph{scene_graph} {}
 
    ~SceneNode() {
       // TODO(fleroviux): debate if we should still signal to the scene graph that the children nodes have been unmounted.
@@ -30,17 +34,32 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
       for(const auto& child : m_children) {
         child->m_parent = nullptr;
       }
+
+      for(u64 component_mask = m_component_mask; component_mask != 0u; component_mask &= component_mask - 1u) {
+        const ComponentTypeID type_id = (ComponentTypeID)std::countr_zero(component_mask);
+        ComponentRegistry::DestroyComponent(type_id, m_components[GetComponentIndex(type_id)]);
+      }
     }
 
     template<typename... Args>
     static std::shared_ptr<SceneNode> New(Args&&... args) {
-      return std::make_shared<SceneNode>(Private{}, std::forward<Args>(args)...);
+      // Nodes are allocated in large numbers, so allocate them together with their control block from a slab pool.
+      return std::allocate_shared<SceneNode>(PoolAllocator<SceneNode>{}, Private{}, std::forward<Args>(args)...);
     }
 
     [[nodiscard]] std::shared_ptr<SceneNode> GetSharedPtr() {
       return shared_from_this();
     }
 
+    /// @returns the handle of the node inside the scene graph it is mounted to, or an invalid handle if the node is not mounted.
+    [[nodiscard]] SceneNodeHandle GetHandle() const {
+      return m_handle;
+    }
+
+    [[nodiscard]] SceneGraph* GetSceneGraph() const {
+      return m_scene_graph;
+    }
+
     [[nodiscard]] SceneNode* GetParent() const {
       return m_parent;
     }
@@ -104,11 +123,22 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
     }
 
     [[nodiscard]] const std::string& GetName() const {
+      return m_name.Get();
+    }
+
+    [[nodiscard]] InternedString GetInternedName() const {
       return m_name;
     }
 
-    void SetName(std::string name) {
-      m_name = std::move(name);
+    void SetName(InternedString name) {
+      if(m_name == name) {
+        return;
+      }
+      const InternedString old_name = m_name;
+      m_name = name;
+      if(m_scene_graph) {
+        m_scene_graph->SignalNodeNameChanged(this, old_name);
+      }
     }
 
     [[nodiscard]] bool IsVisible() const {
@@ -125,6 +155,35 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
       }
     }
 
+    [[nodiscard]] bool IsStatic() const {
+      return m_is_static;
+    }
+
+    /**
+     * Mark the node and its entire subtree as static or dynamic. Nodes added to the subtree later on are dynamic, unless marked otherwise.
+     * The transforms of static nodes are frozen and changing them is an error, until the nodes have been unfrozen via SetStatic(false).
+     * Consumers of the scene may bake the data of static nodes once, so changing the flag of a mounted subtree is relatively expensive.
+     */
+    void SetStatic(bool is_static) {
+      Traverse([&](SceneNode* child_node) {
+        child_node->m_is_static = is_static;
+        return true;
+      });
+      if(m_scene_graph) {
+        m_scene_graph->SignalNodeStaticChanged(this);
+      }
+    }
+
+    /**
+     * Notify the scene graph that the local bounds of one of the node's components changed, for example because a mesh got a new geometry.
+     * Mounting and removing components takes care of this automatically.
+     */
+    void InvalidateLocalBounds() {
+      if(m_scene_graph) {
+        m_scene_graph->SignalNodeLocalBoundsChanged(this);
+      }
+    }
+
     [[nodiscard]] const Transform3D& GetTransform() const {
       return m_transform;
     }
@@ -133,20 +192,91 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
       return m_transform;
     }
 
+    /**
+     * Visit the node and its subtree in depth-first pre-order. Returning false from the functor skips the subtree of the visited node.
+     * The traversal is iterative and works on a per-thread stack that is reused between traversals, so that deep hierarchies cannot
+     * exhaust the call stack and traversals do not allocate memory. The functor may start nested traversals, but must not modify the hierarchy.
+     */
     template<typename Functor>
     void Traverse(const Functor& functor) {
-      if(!functor(this)) {
-        return;
+      std::vector<SceneNode*>& stack = GetTraversalStack();
+
+      // Nested traversals share the stack, but never touch the entries of the enclosing traversals below their base.
+      const size_t stack_base = stack.size();
+      stack.push_back(this);
+
+      while(stack.size() > stack_base) {
+        SceneNode* node = stack.back();
+        stack.pop_back();
+
+        if(!functor(node)) {
+          continue;
+        }
+
+        // Push children in reverse, so that they are visited in order.
+        const auto& children = node->m_children;
+
+        for(auto it = children.rbegin(); it != children.rend(); ++it) {
+          stack.push_back(it->get());
+        }
       }
+    }
 
-      for(auto& child : GetChildren()) {
-        child->Traverse(functor);
+    template<typename Functor>
+    void Traverse(const Functor& functor) const {
+      const_cast<SceneNode*>(this)->Traverse([&](SceneNode* node) {
+        return functor((const SceneNode*)node);
+      });
+    }
+
+    /**
+     * Visit the node and its subtree like Traverse(), but fan independent subtrees out across the threads of a thread pool.
+     * Parents are always visited before their children, but the order of siblings and their subtrees is unspecified.
+     * This is meant for read-only visitors, i.e. for computing bounds or exporting a scene: the functor is invoked concurrently from multiple threads.
+     */
+    template<typename Functor>
+    void ParallelTraverse(ThreadPool& thread_pool, const Functor& functor) const {
+      const size_t number_of_threads = thread_pool.GetNumberOfThreads();
+      const size_t min_number_of_subtrees = number_of_threads * k_parallel_traversal_subtrees_per_thread;
+
+      // Visit the top levels of the hierarchy on the calling thread, until there are enough subtrees to keep all threads busy.
+      std::vector<const SceneNode*> subtrees{this};
+      std::vector<const SceneNode*> next_subtrees{};
+
+      while(!subtrees.empty() && subtrees.size() < min_number_of_subtrees) {
+        next_subtrees.clear();
+
+        for(const auto node : subtrees) {
+          if(functor(node)) {
+            for(const auto& child : node->m_children) {
+              next_subtrees.push_back(child.get());
+            }
+          }
+        }
+
+        std::swap(subtrees, next_subtrees);
+      }
+
+      if(subtrees.empty()) {
+        return;
       }
+
+      // Distribute the subtrees over the threads in contiguous batches.
+      const size_t number_of_batches = std::min(subtrees.size(), min_number_of_subtrees);
+
+      thread_pool.ParallelFor(number_of_batches, [&](size_t batch_index, size_t) {
+        const size_t first_subtree = subtrees.size() * batch_index / number_of_batches;
+        const size_t last_subtree  = subtrees.size() * (batch_index + 1u) / number_of_batches;
+
+        for(size_t subtree = first_subtree; subtree < last_subtree; subtree++) {
+          subtrees[subtree]->Traverse(functor);
+        }
+      });
     }
 
     template<typename T>
     bool HasComponent() const {
-      return m_components.find(std::type_index{typeid(T)}) != m_components.end();
+      return m_component_mask & ((u64)1u << ComponentRegistry::GetTypeID<T>());
     }
 
     template<typename T>
@@ -159,7 +289,7 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
       if(!HasComponent<T>()) {
         ZEPHYR_PANIC("Node does not have a component of the type: '{}'", typeid(T).name());
       }
-      return (T&)*m_components[std::type_index{typeid(T)}];
+      return (T&)*m_components[GetComponentIndex(ComponentRegistry::GetTypeID<T>())];
     }
 
     template<typename T, typename... Args>
@@ -168,14 +298,15 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
         ZEPHYR_PANIC("Node already has a component of the type: '{}'", typeid(T).name());
       }
 
-      std::unique_ptr<T> component = std::make_unique<T>(std::forward<Args>(args)...);
+      const ComponentTypeID type_id = ComponentRegistry::GetTypeID<T>();
+      T* component = ComponentPool<T>::Get().Create(this, std::forward<Args>(args)...);
 
-      T* component_raw_ptr = component.get();
-      m_components[std::type_index{typeid(T)}] = std::move(component);
+      m_components.insert(m_components.begin() + GetComponentIndex(type_id), component);
+      m_component_mask |= (u64)1u << type_id;
       if(m_scene_graph) {
-        m_scene_graph->SignalComponentMounted(this, std::type_index{typeid(T)});
+        m_scene_graph->SignalComponentMounted(this, type_id);
       }
-      return *component_raw_ptr;
+      return *component;
     }
 
     template<typename T>
@@ -183,26 +314,61 @@ class SceneNode : public std::enable_shared_from_this<SceneNode>, NonCopyable, N
       if(!HasComponent<T>()) {
         ZEPHYR_PANIC("Node does not have a component of the type: '{}'", typeid(T).name());
       }
-      m_components.erase(m_components.find(std::type_index{typeid(T)}));
+
+      const ComponentTypeID type_id = ComponentRegistry::GetTypeID<T>();
+      const auto it = m_components.begin() + GetComponentIndex(type_id);
+      T* component = (T*)*it;
+
+      m_components.erase(it);
+      m_component_mask &= ~((u64)1u << type_id);
+      ComponentPool<T>::Get().Destroy(component);
       if(m_scene_graph) {
-        m_scene_graph->SignalComponentRemoved(this, std::type_index{typeid(T)});
+        m_scene_graph->SignalComponentRemoved(this, type_id);
       }
     }
 
-    [[nodiscard]] const std::unordered_map<std::type_index, std::unique_ptr<Component>>& GetComponents() const {
+    /// @returns a bitmask with one bit set for the type ID of each component of the node.
+    [[nodiscard]] u64 GetComponentMask() const {
+      return m_component_mask;
+    }
+
+    /// @returns the components of the node ordered by their type IDs.
+    [[nodiscard]] std::span<Component* const> GetComponents() const {
       return m_components;
     }
 
   private:
+    friend SceneGraph;
     friend Transform3D;
 
+    static constexpr size_t k_parallel_traversal_subtrees_per_thread = 4u;
+
+    // Most nodes have only a few children and components, so these are stored inline and only larger lists are allocated on the heap.
+    static constexpr size_t k_inline_child_capacity = 4u;
+    static constexpr size_t k_inline_component_capacity = 4u;
+
+    /// @returns the stack shared by all traversals on the calling thread.
+    static std::vector<SceneNode*>& GetTraversalStack() {
+      thread_local std::vector<SceneNode*> stack{};
+      return stack;
+    }
+
+    /// @returns the index of the component with the given type ID in m_components, which is the number of components with a lower type ID.
+    [[nodiscard]] size_t GetComponentIndex(ComponentTypeID type_id) const {
+      return (size_t)std::popcount(m_component_mask & (((u64)1u << type_id) - 1u));
+    }
+
     SceneGraph* m_scene_graph{};
+    SceneNodeHandle m_handle{};
     SceneNode* m_parent{};
-    std::vector<std::shared_ptr<SceneNode>> m_children{};
-    std::string m_name{};
+    eastl::fixed_vector<std::shared_ptr<SceneNode>, k_inline_child_capacity> m_children{};
+    InternedString m_name{};
     bool m_is_visible{true};
+    bool m_is_static{false};
+    bool m_is_world_visible{false}; //< Whether the node and all of its ancestors are visible, maintained by the scene graph
     Transform3D m_transform{this};
-    std::unordered_map<std::type_index, std::unique_ptr<Component>> m_components{};
+    u64 m_component_mask{};
+    eastl::fixed_vector<Component*, k_inline_component_capacity> m_components{}; //< Components owned by the node, allocated from the pool of their type
 };
 
 } // namespace zephyr
@@ -1,12 +1,13 @@
-
 #pragma once
 
 #include <zephyr/math/matrix4.hpp>
 #include <zephyr/math/rotation.hpp>
 #include <zephyr/math/vector.hpp>
+#include <zephyr/scene/transform_storage.hpp>
 
 namespace zephyr {
 
+class SceneGraph;
 class SceneNode;
 
 class Transform3D {
@@ -17,47 +18,70 @@ class Transform3D {
     }
 
     [[nodiscard]] const Vector3& GetPosition() const {
-      return m_position;
+      return m_storage ? m_storage->position[m_slot] : m_position;
     }
 
     void SetPosition(const Vector3& position) {
-      m_position = position;
+      (m_storage ? m_storage->position[m_slot] : m_position) = position;
       SignalNodeTransformChanged();
     }
 
     [[nodiscard]] const Vector3& GetScale() const {
-      return m_scale;
+      return m_storage ? m_storage->scale[m_slot] : m_scale;
     }
 
     void SetScale(const Vector3& scale) {
-      m_scale = scale;
+      (m_storage ? m_storage->scale[m_slot] : m_scale) = scale;
       SignalNodeTransformChanged();
     }
 
     [[nodiscard]] const Quaternion& GetRotation() const {
-      return m_rotation;
+      return m_storage ? m_storage->rotation[m_slot] : m_rotation;
     }
 
     void SetRotation(const Quaternion& rotation) {
-      m_rotation = rotation;
+      (m_storage ? m_storage->rotation[m_slot] : m_rotation) = rotation;
       SignalNodeTransformChanged();
     }
 
     [[nodiscard]] const Matrix4& GetLocal() const {
+      if(m_storage) {
+        EvaluateIfStale();
+        return m_storage->local[m_slot];
+      }
       return m_local_matrix;
     }
 
     [[nodiscard]] const Matrix4& GetWorld() const {
+      if(m_storage) {
+        EvaluateIfStale();
+        return m_storage->world[m_slot];
+      }
       return m_world_matrix;
     }
 
     void UpdateLocal();
     void UpdateWorld();
 
+    static Matrix4 ComposeLocal(const Vector3& position, const Quaternion& rotation, const Vector3& scale);
+
   private:
+    friend SceneGraph;
+
     void SignalNodeTransformChanged();
 
+    void EvaluateIfStale() const {
+      if(m_storage->stale[m_slot]) {
+        m_storage->EvaluateStaleMatrices(m_slot);
+      }
+    }
+
     SceneNode* m_node;
+    TransformStorage* m_storage{}; //< The scene graph transform storage, while the node is mounted to a scene graph
+    u32 m_slot{TransformStorage::k_invalid_slot}; //< The slot inside the scene graph transform storage
+    u32 m_dirty_root_index{TransformStorage::k_not_a_dirty_root}; //< The index inside the scene graph's list of dirty roots, if the node is a dirty root
+
+    // Transform state, while the node is not mounted to a scene graph:
     Vector3 m_position{};
     Vector3 m_scale{1.0f, 1.0f, 1.0f};
     Quaternion m_rotation{};
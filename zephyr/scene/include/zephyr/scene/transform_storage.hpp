@@ -0,0 +1,63 @@
+#pragma once
+
+#include <zephyr/math/box3.hpp>
+#include <zephyr/math/matrix4.hpp>
+#include <zephyr/math/quaternion.hpp>
+#include <zephyr/math/vector.hpp>
+#include <zephyr/integer.hpp>
+#include <vector>
+
+namespace zephyr {
+
+class SceneNode;
+
+/**
+ * Structure-of-arrays storage for the transforms of all nodes that are mounted to a scene graph.
+ *
+ * Each mounted node owns one slot and the slots are always kept in parent-before-child order,
+ * meaning that the parent slot of a node always has a lower index than the slot of the node itself.
+ * This allows passes over the scene, i.e. transform updates or compaction, to work in linear sweeps
+ * over the arrays, without ever having to look at the (heap-scattered) scene nodes.
+ *
+ * New subtrees are appended to the end of the arrays, which preserves the ordering. Each slot records the end of its subtree's slot range,
+ * so that the transform update only has to sweep the ranges of the dirty subtrees. Because children may be added to a node
+ * after other nodes have been mounted, the range of a subtree may be interleaved with slots of unrelated nodes, which the sweep skips.
+ * Slots of removed nodes are marked as dead and are eventually dropped by a stable compaction pass.
+ *
+ * When lazy transform evaluation is enabled, the matrices of nodes without components are not recomputed by transform updates.
+ * Instead these nodes are flagged as stale and their matrices are evaluated on demand, together with any stale ancestors.
+ *
+ * Next to the transforms, the storage caches the world-space bounds of each node's subtree. Because children always come after their parent,
+ * these are updated bottom-up by visiting the slots with outdated bounds and their ancestors in reverse order.
+ */
+struct TransformStorage {
+  static constexpr u32 k_invalid_slot = ~0u;
+  static constexpr u32 k_not_a_dirty_root = ~0u; //< The dirty root index of nodes which are not dirty roots
+
+  [[nodiscard]] u32 Size() const {
+    return (u32)node.size();
+  }
+
+  /// Recompute the local and world matrices of a slot from its position, rotation, scale and the world matrix of its parent.
+  void UpdateMatrices(u32 slot);
+
+  /// Bring the matrices of a stale slot up-to-date, by evaluating it and all of its stale ancestors top-down.
+  void EvaluateStaleMatrices(u32 slot);
+
+  std::vector<SceneNode*> node{}; //< The node owning a slot or nullptr if the slot is dead
+  std::vector<u32> parent{}; //< The slot of the parent node or k_invalid_slot for the root node
+  std::vector<u32> subtree_end{}; //< One past the last slot of the node's subtree. The range may also contain slots of unrelated, later mounted nodes.
+  std::vector<u8> dirty{}; //< Whether the node's own transform changed since the last transform update
+  std::vector<Vector3> position{};
+  std::vector<Quaternion> rotation{};
+  std::vector<Vector3> scale{};
+  std::vector<Matrix4> local{};
+  std::vector<Matrix4> world{};
+  std::vector<u8> stale{}; //< Whether the local and world matrices are outdated and must be evaluated before they are read
+  std::vector<u8> bounds_dirty{}; //< Whether the subtree bounds of the node need to be recomputed
+  std::vector<Box3> local_bounds{}; //< The bounds of the node's components in its local space
+  std::vector<Box3> subtree_bounds{}; //< The world-space bounds of the node's components and its entire subtree
+  u32 number_of_dead_slots{};
+};
+
+} // namespace zephyr
@@ -0,0 +1,303 @@
+
+#include <zephyr/scene/animation.hpp>
+#include <zephyr/scene/scene_node.hpp>
+#include <zephyr/panic.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace zephyr {
+
+u32 AnimationClip::AddTrack(u32 target, Channel channel, Interpolation interpolation, std::span<const f32> key_times, std::span<const Vector3> key_values) {
+  if(channel == Channel::Rotation) {
+    ZEPHYR_PANIC("Rotation tracks must be keyed with quaternions");
+  }
+
+  if(key_times.size() != key_values.size()) {
+    ZEPHYR_PANIC("Got {} key times but {} key values", key_times.size(), key_values.size());
+  }
+
+  const u32 first_value = (u32)m_vector_keys.size();
+  m_vector_keys.insert(m_vector_keys.end(), key_values.begin(), key_values.end());
+  return AddTrackKeys(target, channel, interpolation, key_times, first_value);
+}
+
+u32 AnimationClip::AddTrack(u32 target, Interpolation interpolation, std::span<const f32> key_times, std::span<const Quaternion> key_values) {
+  if(key_times.size() != key_values.size()) {
+    ZEPHYR_PANIC("Got {} key times but {} key values", key_times.size(), key_values.size());
+  }
+
+  const u32 first_value = (u32)m_rotation_keys.size();
+  m_rotation_keys.insert(m_rotation_keys.end(), key_values.begin(), key_values.end());
+  return AddTrackKeys(target, Channel::Rotation, interpolation, key_times, first_value);
+}
+
+u32 AnimationClip::AddTrackKeys(u32 target, Channel channel, Interpolation interpolation, std::span<const f32> key_times, u32 first_value) {
+  if(key_times.empty()) {
+    ZEPHYR_PANIC("A track needs at least one keyframe");
+  }
+
+  if(!std::is_sorted(key_times.begin(), key_times.end())) {
+    ZEPHYR_PANIC("The key times of a track must be in ascending order");
+  }
+
+  m_tracks.push_back({
+    .target = target,
+    .channel = channel,
+    .interpolation = interpolation,
+    .first_key = (u32)m_key_times.size(),
+    .first_value = first_value,
+    .number_of_keys = (u32)key_times.size()
+  });
+
+  m_key_times.insert(m_key_times.end(), key_times.begin(), key_times.end());
+  m_number_of_targets = std::max(m_number_of_targets, target + 1u);
+  m_duration = std::max(m_duration, key_times.back());
+  return (u32)m_tracks.size() - 1u;
+}
+
+AnimationSystem::AnimationID AnimationSystem::Play(std::shared_ptr<const AnimationClip> clip, std::span<SceneNode* const> targets, f32 start_time, bool loop) {
+  if(targets.size() < clip->GetNumberOfTargets()) {
+    ZEPHYR_PANIC("The clip animates {} targets, but got only {} nodes", clip->GetNumberOfTargets(), targets.size());
+  }
+
+  AnimationID id;
+
+  if(m_free_animation_ids.empty()) {
+    id = (AnimationID)m_animations.size();
+    m_animations.emplace_back();
+  } else {
+    id = m_free_animation_ids.back();
+    m_free_animation_ids.pop_back();
+  }
+
+  Animation& animation = m_animations[id];
+  animation.targets.clear();
+
+  for(const SceneNode* node : targets) {
+    if(!node->GetHandle().IsValid()) {
+      ZEPHYR_PANIC("Cannot animate the node '{}', since it is not mounted to a scene graph", node->GetName());
+    }
+    animation.targets.push_back(node->GetHandle());
+  }
+
+  animation.key_cursors.assign(clip->GetTracks().size(), 0u);
+  animation.clip = std::move(clip);
+  animation.time = start_time;
+  animation.loop = loop;
+  animation.playing = true;
+  return id;
+}
+
+void AnimationSystem::Stop(AnimationID id) {
+  if(!IsPlaying(id)) {
+    ZEPHYR_PANIC("Animation {} is not playing", id);
+  }
+
+  Animation& animation = m_animations[id];
+  animation.clip.reset();
+  animation.playing = false;
+  m_free_animation_ids.push_back(id);
+}
+
+bool AnimationSystem::IsPlaying(AnimationID id) const {
+  return id < m_animations.size() && m_animations[id].playing;
+}
+
+void AnimationSystem::Update(SceneGraph& scene_graph, f32 delta_time) {
+  m_position_samples.Clear();
+  m_scale_samples.Clear();
+  m_nlerp_samples.Clear();
+  m_slerp_samples.Clear();
+
+  for(AnimationID id = 0u; id < m_animations.size(); id++) {
+    Animation& animation = m_animations[id];
+
+    if(!animation.playing) {
+      continue;
+    }
+
+    const f32 duration = animation.clip->GetDuration();
+    bool finished = false;
+
+    animation.time += delta_time;
+
+    if(animation.loop) {
+      animation.time = duration > 0.0f ? std::fmod(animation.time, duration) : 0.0f;
+    } else if(animation.time >= duration) {
+      animation.time = duration;
+      finished = true;
+    }
+
+    GatherSamples(animation);
+
+    if(finished) {
+      Stop(id);
+    }
+  }
+
+  LerpVectors(m_position_samples, m_vector_results);
+  scene_graph.WritePositions(m_position_samples.nodes, m_vector_results);
+
+  LerpVectors(m_scale_samples, m_vector_results);
+  scene_graph.WriteScales(m_scale_samples.nodes, m_vector_results);
+
+  NLerpRotations(m_nlerp_samples, m_rotation_results);
+  scene_graph.WriteRotations(m_nlerp_samples.nodes, m_rotation_results);
+
+  SLerpRotations(m_slerp_samples, m_rotation_results);
+  scene_graph.WriteRotations(m_slerp_samples.nodes, m_rotation_results);
+}
+
+u32 AnimationSystem::FindKey(std::span<const f32> key_times, u32 cursor, f32 time) {
+  const u32 number_of_keys = (u32)key_times.size();
+
+  // Clips are mostly played forward in small steps, so the key is either the last sampled key or the one after it.
+  for(u32 key = cursor; key < std::min(cursor + 2u, number_of_keys); key++) {
+    if(key_times[key] <= time && (key + 1u == number_of_keys || time < key_times[key + 1u])) {
+      return key;
+    }
+  }
+
+  // Otherwise find the last key at or before the time. Times before the first key map to the first key.
+  const auto it = std::upper_bound(key_times.begin(), key_times.end(), time);
+  return it == key_times.begin() ? 0u : (u32)(it - key_times.begin()) - 1u;
+}
+
+void AnimationSystem::GatherSamples(Animation& animation) {
+  const AnimationClip& clip = *animation.clip;
+  const std::span<const AnimationClip::Track> tracks = clip.GetTracks();
+  const std::span<const f32> key_times = clip.GetKeyTimes();
+  const std::span<const Vector3> vector_keys = clip.GetVectorKeys();
+  const std::span<const Quaternion> rotation_keys = clip.GetRotationKeys();
+  const f32 time = animation.time;
+
+  for(size_t i = 0; i < tracks.size(); i++) {
+    const AnimationClip::Track& track = tracks[i];
+    const std::span<const f32> track_key_times = key_times.subspan(track.first_key, track.number_of_keys);
+
+    const u32 key = FindKey(track_key_times, animation.key_cursors[i], time);
+    const u32 next_key = std::min(key + 1u, track.number_of_keys - 1u);
+    animation.key_cursors[i] = key;
+
+    f32 t = 0.0f;
+
+    if(next_key != key && track.interpolation != AnimationClip::Interpolation::Step) {
+      t = std::clamp((time - track_key_times[key]) / (track_key_times[next_key] - track_key_times[key]), 0.0f, 1.0f);
+    }
+
+    const SceneNodeHandle node = animation.targets[track.target];
+
+    if(track.channel == AnimationClip::Channel::Rotation) {
+      const Quaternion& a = rotation_keys[track.first_value + key];
+      Quaternion b = rotation_keys[track.first_value + next_key];
+
+      // Interpolate along the shorter arc between the two rotations.
+      if(a.Dot(b) < 0.0f) {
+        b = b * -1.0f;
+      }
+
+      SampleBuffer<4>& samples = track.interpolation == AnimationClip::Interpolation::Spherical ? m_slerp_samples : m_nlerp_samples;
+
+      for(int lane = 0; lane < 4; lane++) {
+        samples.a[lane].push_back(a[lane]);
+        samples.b[lane].push_back(b[lane]);
+      }
+      samples.t.push_back(t);
+      samples.nodes.push_back(node);
+    } else {
+      const Vector3& a = vector_keys[track.first_value + key];
+      const Vector3& b = vector_keys[track.first_value + next_key];
+
+      SampleBuffer<3>& samples = track.channel == AnimationClip::Channel::Position ? m_position_samples : m_scale_samples;
+
+      for(int lane = 0; lane < 3; lane++) {
+        samples.a[lane].push_back(a[lane]);
+        samples.b[lane].push_back(b[lane]);
+      }
+      samples.t.push_back(t);
+      samples.nodes.push_back(node);
+    }
+  }
+}
+
+void AnimationSystem::LerpVectors(const SampleBuffer<3>& samples, std::vector<Vector3>& results) {
+  const size_t count = samples.t.size();
+  const f32* t = samples.t.data();
+  const f32* ax = samples.a[0].data();
+  const f32* ay = samples.a[1].data();
+  const f32* az = samples.a[2].data();
+  const f32* bx = samples.b[0].data();
+  const f32* by = samples.b[1].data();
+  const f32* bz = samples.b[2].data();
+
+  results.resize(count);
+
+  for(size_t i = 0; i < count; i++) {
+    results[i] = Vector3{ax[i] + (bx[i] - ax[i]) * t[i], ay[i] + (by[i] - ay[i]) * t[i], az[i] + (bz[i] - az[i]) * t[i]};
+  }
+}
+
+void AnimationSystem::NLerpRotations(const SampleBuffer<4>& samples, std::vector<Quaternion>& results) {
+  const size_t count = samples.t.size();
+  const f32* t = samples.t.data();
+  const f32* aw = samples.a[0].data();
+  const f32* ax = samples.a[1].data();
+  const f32* ay = samples.a[2].data();
+  const f32* az = samples.a[3].data();
+  const f32* bw = samples.b[0].data();
+  const f32* bx = samples.b[1].data();
+  const f32* by = samples.b[2].data();
+  const f32* bz = samples.b[3].data();
+
+  results.resize(count);
+
+  for(size_t i = 0; i < count; i++) {
+    const f32 w = aw[i] + (bw[i] - aw[i]) * t[i];
+    const f32 x = ax[i] + (bx[i] - ax[i]) * t[i];
+    const f32 y = ay[i] + (by[i] - ay[i]) * t[i];
+    const f32 z = az[i] + (bz[i] - az[i]) * t[i];
+    const f32 scale = 1.0f / std::sqrt(w * w + x * x + y * y + z * z);
+
+    results[i] = Quaternion{w * scale, x * scale, y * scale, z * scale};
+  }
+}
+
+void AnimationSystem::SLerpRotations(const SampleBuffer<4>& samples, std::vector<Quaternion>& results) {
+  const size_t count = samples.t.size();
+  const f32* t = samples.t.data();
+  const f32* aw = samples.a[0].data();
+  const f32* ax = samples.a[1].data();
+  const f32* ay = samples.a[2].data();
+  const f32* az = samples.a[3].data();
+  const f32* bw = samples.b[0].data();
+  const f32* bx = samples.b[1].data();
+  const f32* by = samples.b[2].data();
+  const f32* bz = samples.b[3].data();
+
+  results.resize(count);
+
+  for(size_t i = 0; i < count; i++) {
+    const f32 cos_theta = std::min(aw[i] * bw[i] + ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i], 1.0f);
+
+    // Fall back to linear weights for nearly identical rotations, where sin(theta) approaches zero.
+    f32 weight_a = 1.0f - t[i];
+    f32 weight_b = t[i];
+
+    if(cos_theta <= 0.9995f) {
+      const f32 theta = std::acos(cos_theta);
+      const f32 inverse_sin_theta = 1.0f / std::sin(theta);
+      weight_a = std::sin(weight_a * theta) * inverse_sin_theta;
+      weight_b = std::sin(weight_b * theta) * inverse_sin_theta;
+    }
+
+    const f32 w = aw[i] * weight_a + bw[i] * weight_b;
+    const f32 x = ax[i] * weight_a + bx[i] * weight_b;
+    const f32 y = ay[i] * weight_a + by[i] * weight_b;
+    const f32 z = az[i] * weight_a + bz[i] * weight_b;
+    const f32 scale = 1.0f / std::sqrt(w * w + x * x + y * y + z * z);
+
+    results[i] = Quaternion{w * scale, x * scale, y * scale, z * scale};
+  }
+}
+
+} // namespace zephyr
@@ -0,0 +1,23 @@
+#include <zephyr/scene/component.hpp>
+#include <zephyr/panic.hpp>
+#include <array>
+
+namespace zephyr {
+
+static std::array<ComponentRegistry::DestroyFunction, ComponentRegistry::k_max_number_of_types> g_destroy_functions{};
+static size_t g_number_of_types = 0u;
+
+void ComponentRegistry::DestroyComponent(ComponentTypeID type_id, Component* component) {
+  g_destroy_functions[type_id](component);
+}
+
+ComponentTypeID ComponentRegistry::RegisterType(const char* type_name, DestroyFunction destroy_function) {
+  if(g_number_of_types == k_max_number_of_types) {
+    ZEPHYR_PANIC("Exceeded the maximum number of component types ({}) when registering: '{}'", k_max_number_of_types, type_name);
+  }
+
+  g_destroy_functions[g_number_of_types] = destroy_function;
+  return (ComponentTypeID)g_number_of_types++;
+}
+
+} // namespace zephyr
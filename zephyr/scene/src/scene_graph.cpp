@@ -1,140 +1,1047 @@
 
 #include <zephyr/scene/scene_graph.hpp>
 #include <zephyr/scene/scene_node.hpp>
+#include <zephyr/hash.hpp>
+#include <zephyr/panic.hpp>
 #include <algorithm>
+#include <functional>
 
 namespace zephyr {
 
+static Box3 ComputeLocalBounds(const SceneNode* node) {
+  Box3 bounds = Box3::Empty();
+
+  for(const Component* component : node->GetComponents()) {
+    bounds = bounds.Union(component->GetLocalBounds());
+  }
+  return bounds;
+}
+
 SceneGraph::SceneGraph() {
   m_root_node = SceneNode::New("SceneRoot", this);
   SignalNodeMounted(m_root_node.get());
 }
 
+SceneGraph::~SceneGraph() {
+  // Nodes may outlive the scene graph, so make sure that they do not reference the transform storage anymore.
+  UnregisterSubtree(m_root_node.get());
+}
+
+void SceneGraph::BeginBatch() {
+  if(m_batch_depth++ == 0u) {
+    m_batch_first_slot = m_transform_storage.Size();
+  }
+}
+
+void SceneGraph::EndBatch() {
+  if(m_batch_depth == 0u) {
+    ZEPHYR_PANIC("EndBatch() was called without a matching call to BeginBatch()");
+  }
+
+  if(--m_batch_depth > 0u) {
+    return;
+  }
+
+  TransformStorage& storage = m_transform_storage;
+  const u32 slot_count = storage.Size();
+
+  // The storage never gets compacted during a batch, so all nodes mounted during the batch are found past the first batch slot.
+  // Thanks to the parent-before-child order, the world visibility of a node's parent is always known when the node is visited.
+  for(u32 slot = m_batch_first_slot; slot < slot_count; slot++) {
+    SceneNode* node = storage.node[slot];
+    if(!node) {
+      continue;
+    }
+
+    // Only the roots of the mounted subtrees need to be flagged dirty, the change is propagated to their descendants.
+    const u32 parent_slot = storage.parent[slot];
+    if(parent_slot == TransformStorage::k_invalid_slot || parent_slot < m_batch_first_slot) {
+      SignalNodeTransformChanged(node);
+    }
+
+    // Visibility changes during the batch may have updated the world visibility of some nodes already.
+    const SceneNode* parent_node = node->GetParent();
+    const bool world_visible = node->IsVisible() && (!parent_node || parent_node->m_is_world_visible);
+
+    if(node->m_is_world_visible != world_visible) {
+      node->m_is_world_visible = world_visible;
+      PushScenePatch(world_visible ? ScenePatch::Type::NodeMounted : ScenePatch::Type::NodeRemoved, node);
+    }
+  }
+}
+
 void SceneGraph::UpdateTransforms() {
-  for(const auto node : m_nodes_with_dirty_transform) {
-    node->GetTransform().UpdateLocal();
-    node->GetTransform().UpdateWorld();
-
-    if(QueryNodeWorldVisibility(node)) { // TODO(fleroviux): this check is slow!
-      m_scene_patches.push_back({
-        .type = ScenePatch::Type::NodeTransformChanged,
-        .node = node->GetSharedPtr()
+  if(m_batch_depth > 0u) {
+    ZEPHYR_PANIC("Transforms cannot be updated while a batch is open");
+  }
+
+  CompactTransformStorageIfNeeded();
+  BeginWorldMatrixSnapshot();
+
+  std::vector<u32>& snapshot_writes = m_world_matrix_snapshot_writes[m_world_matrix_snapshot];
+
+  TransformStorage& storage = m_transform_storage;
+
+  /**
+   * Recompute the subtree of each independent dirty root exactly once, no matter how often its transform or the transforms
+   * of its ancestors were changed. Slots are in parent-before-child order, so a forward sweep over the slot range of a root's subtree
+   * always sees an up-to-date parent world matrix. The range may contain slots of other subtrees which were mounted later,
+   * so the root is flagged dirty and the flag is passed on to each slot whose parent is flagged.
+   * All dirty flags have been cleared while collecting the jobs, so afterwards the flags in the range can simply be reset.
+   */
+  for(const auto node : CollectTransformUpdateJobs()) {
+    const u32 root_slot = node->GetTransform().m_slot;
+    const u32 end_slot = storage.subtree_end[root_slot];
+
+    storage.dirty[root_slot] = 1u;
+
+    for(u32 slot = root_slot; slot < end_slot; slot++) {
+      if(slot != root_slot) {
+        const u32 parent_slot = storage.parent[slot];
+
+        if(parent_slot == TransformStorage::k_invalid_slot || !storage.dirty[parent_slot]) {
+          continue;
+        }
+        storage.dirty[slot] = 1u;
+      }
+
+      if(UpdateTransformSlot(slot, snapshot_writes, m_bounds_dirty_slots)) {
+        PushScenePatch(ScenePatch::Type::NodeTransformChanged, storage.node[slot]);
+      }
+    }
+
+    std::fill(storage.dirty.begin() + root_slot, storage.dirty.begin() + end_slot, 0u);
+  }
+
+  UpdateSubtreeBounds();
+}
+
+void SceneGraph::UpdateTransforms(ThreadPool& thread_pool) {
+  if(m_batch_depth > 0u) {
+    ZEPHYR_PANIC("Transforms cannot be updated while a batch is open");
+  }
+
+  CompactTransformStorageIfNeeded();
+  BeginWorldMatrixSnapshot();
+
+  std::vector<u32>& snapshot_writes = m_world_matrix_snapshot_writes[m_world_matrix_snapshot];
+  std::vector<SceneNode*>& jobs = CollectTransformUpdateJobs();
+
+  const size_t number_of_threads = thread_pool.GetNumberOfThreads();
+  const size_t min_number_of_jobs = number_of_threads * k_transform_update_jobs_per_thread;
+
+  // If there are too few jobs to keep all threads busy, update the job roots right away and split their children into separate jobs.
+  std::vector<SceneNode*>& next_jobs = m_transform_update_next_jobs;
+
+  while(!jobs.empty() && jobs.size() < min_number_of_jobs) {
+    next_jobs.clear();
+
+    for(const auto node : jobs) {
+      if(UpdateTransformSlot(node->GetTransform().m_slot, snapshot_writes, m_bounds_dirty_slots)) {
+        PushScenePatch(ScenePatch::Type::NodeTransformChanged, node);
+      }
+
+      for(const auto& child_node : node->GetChildren()) {
+        next_jobs.push_back(child_node.get());
+      }
+    }
+
+    std::swap(jobs, next_jobs);
+  }
+
+  if(jobs.empty()) {
+    UpdateSubtreeBounds();
+    return;
+  }
+
+  // Job roots updated by the loop above are left stale when lazy transform evaluation skips them. Their children are split
+  // into separate jobs, which would otherwise evaluate them from multiple threads at once.
+  EvaluateStaleJobParents(jobs);
+
+  // Distribute the subtrees over the threads in contiguous batches. Each thread collects the nodes that need a patch,
+  // the written world matrix snapshot entries and the slots with outdated bounds in its own lists.
+  const size_t number_of_batches = std::min(jobs.size(), min_number_of_jobs);
+
+  m_thread_local_transform_patches.resize(number_of_threads);
+  m_thread_local_snapshot_writes.resize(number_of_threads);
+  m_thread_local_bounds_dirty_slots.resize(number_of_threads);
+
+  thread_pool.ParallelFor(number_of_batches, [&](size_t batch_index, size_t thread_index) {
+    std::vector<SceneNode*>& transform_patches = m_thread_local_transform_patches[thread_index];
+    std::vector<u32>& thread_snapshot_writes = m_thread_local_snapshot_writes[thread_index];
+    std::vector<u32>& thread_bounds_dirty_slots = m_thread_local_bounds_dirty_slots[thread_index];
+
+    const size_t first_job = jobs.size() * batch_index / number_of_batches;
+    const size_t last_job  = jobs.size() * (batch_index + 1u) / number_of_batches;
+
+    for(size_t job = first_job; job < last_job; job++) {
+      jobs[job]->Traverse([&](SceneNode* child_node) {
+        if(UpdateTransformSlot(child_node->GetTransform().m_slot, thread_snapshot_writes, thread_bounds_dirty_slots)) {
+          transform_patches.push_back(child_node);
+        }
+        return true;
       });
     }
+  });
+
+  for(std::vector<SceneNode*>& transform_patches : m_thread_local_transform_patches) {
+    for(const auto node : transform_patches) {
+      PushScenePatch(ScenePatch::Type::NodeTransformChanged, node);
+    }
+    transform_patches.clear();
+  }
+
+  for(std::vector<u32>& thread_snapshot_writes : m_thread_local_snapshot_writes) {
+    snapshot_writes.insert(snapshot_writes.end(), thread_snapshot_writes.begin(), thread_snapshot_writes.end());
+    thread_snapshot_writes.clear();
+  }
+
+  for(std::vector<u32>& thread_bounds_dirty_slots : m_thread_local_bounds_dirty_slots) {
+    m_bounds_dirty_slots.insert(m_bounds_dirty_slots.end(), thread_bounds_dirty_slots.begin(), thread_bounds_dirty_slots.end());
+    thread_bounds_dirty_slots.clear();
+  }
+
+  UpdateSubtreeBounds();
+}
+
+template<typename T>
+void SceneGraph::WriteTransformChannel(std::vector<T> TransformStorage::* channel, std::span<const SceneNodeHandle> nodes, std::span<const T> values) {
+  if(nodes.size() != values.size()) {
+    ZEPHYR_PANIC("Got {} nodes but {} values", nodes.size(), values.size());
+  }
+
+  std::vector<T>& channel_values = m_transform_storage.*channel;
+
+  for(size_t i = 0; i < nodes.size(); i++) {
+    SceneNode* node = GetNode(nodes[i]);
+
+    if(!node) {
+      continue;
+    }
+
+    if(node->m_is_static) {
+      ZEPHYR_PANIC("Cannot change the transform of the static node '{}', unfreeze it via SceneNode::SetStatic(false) first", node->GetName());
+    }
+
+    channel_values[node->GetTransform().m_slot] = values[i];
+    SignalNodeTransformChanged(node);
+  }
+}
+
+void SceneGraph::WritePositions(std::span<const SceneNodeHandle> nodes, std::span<const Vector3> positions) {
+  WriteTransformChannel(&TransformStorage::position, nodes, positions);
+}
+
+void SceneGraph::WriteRotations(std::span<const SceneNodeHandle> nodes, std::span<const Quaternion> rotations) {
+  WriteTransformChannel(&TransformStorage::rotation, nodes, rotations);
+}
+
+void SceneGraph::WriteScales(std::span<const SceneNodeHandle> nodes, std::span<const Vector3> scales) {
+  WriteTransformChannel(&TransformStorage::scale, nodes, scales);
+}
+
+SceneNode* SceneGraph::FindNode(std::string_view name) const {
+  const std::span<SceneNode* const> nodes = FindNodes(name);
+  return nodes.empty() ? nullptr : nodes[0];
+}
+
+std::span<SceneNode* const> SceneGraph::FindNodes(std::string_view name) const {
+  // A name which has never been interned cannot belong to any node.
+  const std::optional<InternedString> interned_name = InternedString::Find(name);
+  if(!interned_name) {
+    return {};
+  }
+
+  const auto match = m_nodes_by_name.find(*interned_name);
+  if(match == m_nodes_by_name.end()) {
+    return {};
+  }
+  return match->second;
+}
+
+SceneNode* SceneGraph::FindNodeByPath(std::string_view path) const {
+  if(path.empty()) {
+    return m_root_node.get();
+  }
+  return FindNodeByPath(m_root_node.get(), path);
+}
+
+SceneNode* SceneGraph::FindNodeByPath(const SceneNode* parent_node, std::string_view path) const {
+  const size_t separator = path.find('/');
+  const std::string_view remaining_path = separator == std::string_view::npos ? std::string_view{} : path.substr(separator + 1u);
+
+  const std::optional<InternedString> name = InternedString::Find(path.substr(0u, separator));
+  if(!name) {
+    return nullptr;
+  }
+
+  const auto match = m_child_by_name.find({.parent_index = parent_node->m_handle.index, .name = *name});
+  if(match == m_child_by_name.end()) {
+    return nullptr;
+  }
+
+  SceneNode* child_node = match->second;
+
+  if(remaining_path.empty()) {
+    return child_node;
+  }
+
+  if(SceneNode* node = FindNodeByPath(child_node, remaining_path); node) {
+    return node;
+  }
+
+  // The indexed child is a dead end, but a sibling sharing its name may still lead to a matching node.
+  for(const auto& sibling_node : parent_node->GetChildren()) {
+    if(sibling_node.get() != child_node && sibling_node->m_name == *name) {
+      if(SceneNode* node = FindNodeByPath(sibling_node.get(), remaining_path); node) {
+        return node;
+      }
+    }
   }
-  m_nodes_with_dirty_transform.clear();
+  return nullptr;
 }
 
-bool SceneGraph::QueryNodeWorldVisibility(const SceneNode* node) {
-  return m_node_world_visibility[node];
+void SceneGraph::ClearScenePatches() {
+  for(const ScenePatch& patch : m_scene_patches) {
+    if(patch.node.IsValid()) {
+      NodeTableEntry& entry = m_node_table[patch.node.index];
+      entry.last_scene_patch = k_no_scene_patch;
+      entry.mounted_this_frame = false;
+      entry.transform_patched = false;
+    }
+  }
+
+  m_scene_patches.clear();
+  m_previous_scene_patch_of_node.clear();
+  m_number_of_dead_scene_patches = 0u;
+
+  // Patches referencing removed nodes are gone now, so their node table entries can be reused.
+  m_free_node_table_indices.insert(m_free_node_table_indices.end(), m_node_table_indices_to_free.begin(), m_node_table_indices_to_free.end());
+  m_node_table_indices_to_free.clear();
+}
+
+std::span<ScenePatch const> SceneGraph::GetScenePatches() {
+  if(m_number_of_dead_scene_patches > 0u) {
+    CompactScenePatches();
+  }
+  return m_scene_patches;
+}
+
+void SceneGraph::SetLazyTransformEvaluation(bool enabled) {
+  if(!enabled && m_lazy_transform_evaluation) {
+    // Evaluate all stale matrices in a single sweep. Thanks to the parent-before-child order, parents are always evaluated first.
+    TransformStorage& storage = m_transform_storage;
+
+    for(u32 slot = 0u; slot < storage.Size(); slot++) {
+      if(storage.stale[slot]) {
+        storage.UpdateMatrices(slot);
+        storage.stale[slot] = 0u;
+      }
+    }
+  }
+
+  m_lazy_transform_evaluation = enabled;
+}
+
+bool SceneGraph::QueryNodeWorldVisibility(const SceneNode* node) const {
+  return node->m_is_world_visible;
+}
+
+const Box3& SceneGraph::GetSubtreeBounds(const SceneNode* node) const {
+  return m_transform_storage.subtree_bounds[node->GetTransform().m_slot];
 }
 
 void SceneGraph::SignalNodeMounted(SceneNode* node) {
+  RegisterSubtree(node);
+
+  // Dirty transforms and visibility of nodes mounted during a batch are handled in EndBatch().
+  if(m_batch_depth > 0u) {
+    return;
+  }
+
   SignalNodeTransformChanged(node);
-  SignalNodeVisibilityChanged(node, node->IsVisible());
 
-  if(QueryNodeWorldVisibility(node)) {
-    node->Traverse([this](SceneNode* child_node) {
-      if(child_node->IsVisible()) {
-        m_scene_patches.push_back({
-          .type = ScenePatch::Type::NodeMounted,
-          .node = child_node->GetSharedPtr()
-        });
-        return true;
-      }
+  const SceneNode* parent_node = node->GetParent();
 
-      return false;
-    });
+  if(!parent_node || parent_node->m_is_world_visible) {
+    MarkSubtreeWorldVisible(node);
   }
 }
 
 void SceneGraph::SignalNodeRemoved(SceneNode* node) {
+  MarkSubtreeWorldInvisible(node);
+  UnregisterSubtree(node);
+}
+
+void SceneGraph::SignalComponentMounted(SceneNode* node, ComponentTypeID type_id) {
+  SignalNodeLocalBoundsChanged(node);
+
+  // Lazy transform updates skip nodes without components, so the world matrix snapshot may lack the node's world matrix.
+  if(node->m_component_mask == ((u64)1u << type_id)) {
+    SignalNodeTransformChanged(node);
+  }
+
   if(QueryNodeWorldVisibility(node)) {
-    node->Traverse([this](SceneNode* child_node) {
-      if(child_node->IsVisible()) {
-        m_scene_patches.push_back({
-          .type = ScenePatch::Type::NodeRemoved,
-          .node = child_node->GetSharedPtr()
-        });
-        return true;
+    PushScenePatch(ScenePatch::Type::ComponentMounted, node, type_id);
+  }
+}
+
+void SceneGraph::SignalComponentRemoved(SceneNode* node, ComponentTypeID type_id) {
+  SignalNodeLocalBoundsChanged(node);
+
+  if(QueryNodeWorldVisibility(node)) {
+    PushScenePatch(ScenePatch::Type::ComponentRemoved, node, type_id);
+  }
+}
+
+void SceneGraph::SignalNodeTransformChanged(SceneNode* node) {
+  // Descendants are not flagged here, the change is propagated to them once in UpdateTransforms().
+  Transform3D& transform = node->GetTransform();
+
+  if(IsSlotMountedInBatch(transform.m_slot)) {
+    return;
+  }
+
+  u8& dirty = m_transform_storage.dirty[transform.m_slot];
+
+  if(!dirty) {
+    dirty = 1u;
+    transform.m_dirty_root_index = (u32)m_dirty_transform_roots.size();
+    m_dirty_transform_roots.push_back(node);
+  }
+}
+
+void SceneGraph::SignalNodeVisibilityChanged(SceneNode* node, bool visible) {
+  if(visible) {
+    const SceneNode* parent_node = node->GetParent();
+
+    if(!parent_node || parent_node->m_is_world_visible) {
+      MarkSubtreeWorldVisible(node);
+    }
+  } else {
+    MarkSubtreeWorldInvisible(node);
+  }
+}
+
+void SceneGraph::SignalNodeStaticChanged(SceneNode* node) {
+  // Remount the subtree, so that consumers of the scene patches get to rebuild any data that they derived from the static flag.
+  if(node->m_is_world_visible) {
+    MarkSubtreeWorldInvisible(node);
+    MarkSubtreeWorldVisible(node);
+  }
+}
+
+void SceneGraph::SignalNodeLocalBoundsChanged(SceneNode* node) {
+  const u32 slot = node->GetTransform().m_slot;
+
+  m_transform_storage.local_bounds[slot] = ComputeLocalBounds(node);
+  MarkBoundsDirty(slot);
+}
+
+void SceneGraph::SignalNodeNameChanged(SceneNode* node, InternedString old_name) {
+  const SceneNode* parent_node = node->GetParent();
+
+  RemoveFromNameIndex(node, old_name, parent_node, true);
+  AddToNameIndex(node, node->m_name, parent_node);
+}
+
+void SceneGraph::MarkSubtreeWorldVisible(SceneNode* node) {
+  if(!node->IsVisible()) {
+    return;
+  }
+
+  std::vector<SceneNode*>& stack = m_traversal_stack;
+  stack.push_back(node);
+
+  while(!stack.empty()) {
+    SceneNode* current_node = stack.back();
+    stack.pop_back();
+
+    current_node->m_is_world_visible = true;
+
+    PushScenePatch(ScenePatch::Type::NodeMounted, current_node);
+
+    // Push children in reverse, so that they are visited in order. Invisible children hide their entire subtree.
+    // Children mounted during an open batch are left for EndBatch() to handle.
+    const auto children = current_node->GetChildren();
+
+    for(auto it = children.rbegin(); it != children.rend(); ++it) {
+      if((*it)->IsVisible() && !IsSlotMountedInBatch((*it)->GetTransform().m_slot)) {
+        stack.push_back(it->get());
       }
+    }
+  }
+}
 
-      return false;
-    });
+void SceneGraph::MarkSubtreeWorldInvisible(SceneNode* node) {
+  if(!node->m_is_world_visible) {
+    return;
   }
 
-  node->Traverse([this](SceneNode* child_node) {
-    const auto match = std::ranges::find(m_nodes_with_dirty_transform, child_node);
-    if(match != m_nodes_with_dirty_transform.end()) {
-      m_nodes_with_dirty_transform.erase(match);
+  std::vector<SceneNode*>& stack = m_traversal_stack;
+  stack.push_back(node);
+
+  while(!stack.empty()) {
+    SceneNode* current_node = stack.back();
+    stack.pop_back();
+
+    current_node->m_is_world_visible = false;
+
+    PushScenePatch(ScenePatch::Type::NodeRemoved, current_node);
+
+    const auto children = current_node->GetChildren();
+
+    for(auto it = children.rbegin(); it != children.rend(); ++it) {
+      if((*it)->m_is_world_visible) {
+        stack.push_back(it->get());
+      }
     }
+  }
+}
+
+void SceneGraph::RegisterSubtree(SceneNode* node) {
+  TransformStorage& storage = m_transform_storage;
+  const u32 first_slot = storage.Size();
+
+  // Appending the subtree in traversal order keeps the storage in parent-before-child order.
+  node->Traverse([&](SceneNode* child_node) {
+    u32 node_table_index;
+
+    if(m_free_node_table_indices.empty()) {
+      node_table_index = (u32)m_node_table.size();
+      m_node_table.emplace_back();
+    } else {
+      node_table_index = m_free_node_table_indices.back();
+      m_free_node_table_indices.pop_back();
+    }
+
+    NodeTableEntry& entry = m_node_table[node_table_index];
+    entry.node = child_node;
+    child_node->m_handle = {.index = node_table_index, .generation = entry.generation};
+
+    AddToNameIndex(child_node, child_node->m_name, child_node->GetParent());
+
+    Transform3D& transform = child_node->GetTransform();
+    SceneNode* parent_node = child_node->GetParent();
+
+    const u32 slot = storage.Size();
+    storage.node.push_back(child_node);
+    storage.parent.push_back(parent_node ? parent_node->GetTransform().m_slot : TransformStorage::k_invalid_slot);
+    storage.subtree_end.push_back(slot + 1u);
+    storage.dirty.push_back(0u);
+    storage.position.push_back(transform.m_position);
+    storage.rotation.push_back(transform.m_rotation);
+    storage.scale.push_back(transform.m_scale);
+    storage.local.push_back(transform.m_local_matrix);
+    storage.world.push_back(transform.m_world_matrix);
+    storage.stale.push_back(0u);
+    storage.bounds_dirty.push_back(1u);
+    m_bounds_dirty_slots.push_back(slot);
+    storage.local_bounds.push_back(ComputeLocalBounds(child_node));
+    storage.subtree_bounds.push_back(Box3::Empty());
+
+    transform.m_storage = &storage;
+    transform.m_slot = slot;
     return true;
   });
-}
 
-void SceneGraph::SignalComponentMounted(SceneNode* node, std::type_index type_index) {
-  if(QueryNodeWorldVisibility(node)) {
-    m_scene_patches.push_back({
-      .type = ScenePatch::Type::ComponentMounted,
-      .node = node->GetSharedPtr(),
-      .component_type = type_index
-    });
+  // Extend the slot ranges of the new nodes to their descendants, which come after them. The subtree has been appended
+  // to the end of the storage, so the ranges of its ancestors now reach the end of the storage.
+  const u32 slot_count = storage.Size();
+
+  for(u32 slot = slot_count; slot-- > first_slot + 1u;) {
+    const u32 parent_slot = storage.parent[slot];
+    storage.subtree_end[parent_slot] = std::max(storage.subtree_end[parent_slot], storage.subtree_end[slot]);
   }
-}
 
-void SceneGraph::SignalComponentRemoved(SceneNode* node, std::type_index type_index) {
-  if(QueryNodeWorldVisibility(node)) {
-    m_scene_patches.push_back({
-      .type = ScenePatch::Type::ComponentRemoved,
-      .node = node->GetSharedPtr(),
-      .component_type = type_index
-    });
+  for(u32 slot = storage.parent[first_slot]; slot != TransformStorage::k_invalid_slot; slot = storage.parent[slot]) {
+    storage.subtree_end[slot] = slot_count;
   }
 }
 
-void SceneGraph::SignalNodeTransformChanged(SceneNode* node) {
-  // TODO(fleroviux): try to efficiently eliminate redundant updates.
-  node->Traverse([this](SceneNode* child_node) {
-    m_nodes_with_dirty_transform.push_back(child_node);
+void SceneGraph::UnregisterSubtree(SceneNode* node) {
+  TransformStorage& storage = m_transform_storage;
+
+  // The subtree bounds of the former parent (and thus its ancestors) have to shrink.
+  const u32 parent_slot = storage.parent[node->GetTransform().m_slot];
+
+  if(parent_slot != TransformStorage::k_invalid_slot) {
+    MarkBoundsDirty(parent_slot);
+  }
+
+  // The parent pointer of the subtree root is cleared already, but its transform slot still references the parent.
+  const SceneNode* root_parent_node = parent_slot != TransformStorage::k_invalid_slot ? storage.node[parent_slot] : nullptr;
+
+  // The name index is keyed by the node table index of the parent, so it must be cleaned up before any handle in the subtree is invalidated.
+  node->Traverse([&](SceneNode* child_node) {
+    // Siblings of the subtree root stay mounted and one of them may have to take over the root's entry in the name index.
+    // All other nodes are removed along with their siblings.
+    if(child_node == node) {
+      RemoveFromNameIndex(child_node, child_node->m_name, root_parent_node, true);
+    } else {
+      RemoveFromNameIndex(child_node, child_node->m_name, child_node->GetParent(), false);
+    }
+    return true;
+  });
+
+  node->Traverse([&](SceneNode* child_node) {
+    // Invalidate all outstanding handles to the node. The entry is not reused before the patches are cleared,
+    // because a NodeRemoved patch for the node may still reference it.
+    const u32 node_table_index = child_node->m_handle.index;
+    NodeTableEntry& entry = m_node_table[node_table_index];
+    entry.node = nullptr;
+    entry.generation++;
+    m_node_table_indices_to_free.push_back(node_table_index);
+    child_node->m_handle = {};
+
+    Transform3D& transform = child_node->GetTransform();
+    const u32 slot = transform.m_slot;
+
+    // Swap-and-pop the node from the list of dirty roots, so that bulk removal of dirty subtrees stays linear.
+    if(transform.m_dirty_root_index != TransformStorage::k_not_a_dirty_root) {
+      SceneNode* last_dirty_root = m_dirty_transform_roots.back();
+      m_dirty_transform_roots[transform.m_dirty_root_index] = last_dirty_root;
+      last_dirty_root->GetTransform().m_dirty_root_index = transform.m_dirty_root_index;
+      m_dirty_transform_roots.pop_back();
+      transform.m_dirty_root_index = TransformStorage::k_not_a_dirty_root;
+    }
+
+    // Hand the transform state back to the node, so that it can be used while the node is not mounted.
+    // The parent has been handed back already, but its matrices are still in the storage and are up-to-date.
+    if(storage.stale[slot]) {
+      storage.EvaluateStaleMatrices(slot);
+    }
+
+    transform.m_position = storage.position[slot];
+    transform.m_rotation = storage.rotation[slot];
+    transform.m_scale = storage.scale[slot];
+    transform.m_local_matrix = storage.local[slot];
+    transform.m_world_matrix = storage.world[slot];
+    transform.m_storage = nullptr;
+    transform.m_slot = TransformStorage::k_invalid_slot;
+
+    // Detach dead slots from their parent, so that dirty flags are never propagated into them.
+    storage.node[slot] = nullptr;
+    storage.parent[slot] = TransformStorage::k_invalid_slot;
+    storage.dirty[slot] = 0u;
+    storage.bounds_dirty[slot] = 0u;
+    storage.number_of_dead_slots++;
     return true;
   });
 }
 
-void SceneGraph::SignalNodeVisibilityChanged(SceneNode* node, bool visible) {
-  if(visible) {
-    SceneNode* parent_node = node->GetParent();
+size_t SceneGraph::ChildKeyHash::operator()(const ChildKey& key) const {
+  size_t hash = std::hash<u32>{}(key.parent_index);
+  hash_combine(hash, key.name);
+  return hash;
+}
+
+void SceneGraph::AddToNameIndex(SceneNode* node, InternedString name, const SceneNode* parent_node) {
+  std::vector<SceneNode*>& nodes = m_nodes_by_name[name];
+  m_node_table[node->m_handle.index].name_index = (u32)nodes.size();
+  nodes.push_back(node);
+
+  // If a sibling with the same name is indexed already, it is kept.
+  if(parent_node) {
+    m_child_by_name.try_emplace({.parent_index = parent_node->m_handle.index, .name = name}, node);
+  }
+}
+
+void SceneGraph::RemoveFromNameIndex(SceneNode* node, InternedString name, const SceneNode* parent_node, bool hand_over_to_sibling) {
+  // Swap-and-pop the node from the list of nodes with its name.
+  const auto match = m_nodes_by_name.find(name);
+  std::vector<SceneNode*>& nodes = match->second;
+  const u32 name_index = m_node_table[node->m_handle.index].name_index;
+
+  SceneNode* last_node = nodes.back();
+  nodes[name_index] = last_node;
+  m_node_table[last_node->m_handle.index].name_index = name_index;
+  nodes.pop_back();
+
+  if(nodes.empty()) {
+    m_nodes_by_name.erase(match);
+  }
+
+  if(!parent_node) {
+    return;
+  }
+
+  const auto child_match = m_child_by_name.find({.parent_index = parent_node->m_handle.index, .name = name});
+
+  if(child_match == m_child_by_name.end() || child_match->second != node) {
+    return;
+  }
+
+  // Let the first remaining sibling with the same name take over the entry, if there is one.
+  if(hand_over_to_sibling) {
+    for(const auto& sibling_node : parent_node->GetChildren()) {
+      if(sibling_node.get() != node && sibling_node->m_name == name && sibling_node->m_handle.IsValid()) {
+        child_match->second = sibling_node.get();
+        return;
+      }
+    }
+  }
+
+  m_child_by_name.erase(child_match);
+}
+
+void SceneGraph::BeginWorldMatrixSnapshot() {
+  const u32 previous_snapshot = m_world_matrix_snapshot;
+  const u32 snapshot = previous_snapshot ^ 1u;
+
+  std::vector<Matrix4>& world_matrices = m_world_matrix_snapshots[snapshot];
+  const std::vector<Matrix4>& previous_world_matrices = m_world_matrix_snapshots[previous_snapshot];
+
+  // Entries may be written concurrently during the update, so the snapshot has to be sized up-front.
+  world_matrices.resize(m_node_table.size());
+
+  /**
+   * The snapshot is two updates old, so bring it up-to-date with the entries written by the previous update, before writing the changes of this update.
+   * The previous snapshot may still be read by another thread at this point, but it is only read from here.
+   * Entries of nodes which have been removed in the meantime are copied as well, which is harmless.
+   */
+  for(const u32 index : m_world_matrix_snapshot_writes[previous_snapshot]) {
+    world_matrices[index] = previous_world_matrices[index];
+  }
+
+  m_world_matrix_snapshot_writes[snapshot].clear();
+  m_world_matrix_snapshot = snapshot;
+}
+
+std::vector<SceneNode*>& SceneGraph::CollectTransformUpdateJobs() {
+  TransformStorage& storage = m_transform_storage;
+
+  // Dirty roots which are not part of the subtree of another dirty root can be updated independently of each other.
+  std::vector<SceneNode*>& jobs = m_transform_update_jobs;
+  jobs.clear();
+
+  for(const auto node : m_dirty_transform_roots) {
+    bool is_nested_root = false;
+
+    for(u32 slot = storage.parent[node->GetTransform().m_slot]; slot != TransformStorage::k_invalid_slot; slot = storage.parent[slot]) {
+      if(storage.dirty[slot]) {
+        is_nested_root = true;
+        break;
+      }
+    }
+
+    if(!is_nested_root) {
+      jobs.push_back(node);
+    }
+  }
+
+  // Each job recomputes its entire subtree, so the dirty flags are not needed anymore.
+  for(const auto node : m_dirty_transform_roots) {
+    Transform3D& transform = node->GetTransform();
+    storage.dirty[transform.m_slot] = 0u;
+    transform.m_dirty_root_index = TransformStorage::k_not_a_dirty_root;
+  }
+  m_dirty_transform_roots.clear();
+
+  EvaluateStaleJobParents(jobs);
+  return jobs;
+}
+
+void SceneGraph::EvaluateStaleJobParents(std::span<SceneNode* const> jobs) {
+  TransformStorage& storage = m_transform_storage;
+
+  // Evaluating a stale slot writes to its stale ancestors, which may be shared between jobs and thus cannot be evaluated concurrently.
+  for(const auto node : jobs) {
+    const u32 parent_slot = storage.parent[node->GetTransform().m_slot];
+
+    if(parent_slot != TransformStorage::k_invalid_slot && storage.stale[parent_slot]) {
+      storage.EvaluateStaleMatrices(parent_slot);
+    }
+  }
+}
 
-    if(!parent_node || m_node_world_visibility[parent_node]) {
-      m_node_world_visibility[node] = true;
+bool SceneGraph::UpdateTransformSlot(u32 slot, std::vector<u32>& snapshot_writes, std::vector<u32>& bounds_dirty_slots) {
+  TransformStorage& storage = m_transform_storage;
+  const SceneNode* node = storage.node[slot];
 
-      node->Traverse([this](SceneNode* child_node) {
-        if(child_node->IsVisible()) {
-          m_node_world_visibility[child_node] = true;
+  // Without components nothing in the scene consumes the matrices of the node, so they can be left for on-demand evaluation.
+  if(m_lazy_transform_evaluation && node->m_component_mask == 0u) {
+    storage.stale[slot] = 1u;
+  } else {
+    const u32 parent_slot = storage.parent[slot];
 
-          m_scene_patches.push_back({
-            .type = ScenePatch::Type::NodeMounted,
-            .node = child_node->GetSharedPtr()
-          });
-          return true;
+    if(parent_slot != TransformStorage::k_invalid_slot && storage.stale[parent_slot]) {
+      storage.EvaluateStaleMatrices(parent_slot);
+    }
+    storage.UpdateMatrices(slot);
+    storage.stale[slot] = 0u;
+
+    const u32 node_table_index = node->m_handle.index;
+    m_world_matrix_snapshots[m_world_matrix_snapshot][node_table_index] = storage.world[slot];
+    snapshot_writes.push_back(node_table_index);
+  }
+
+  // Moving the node moves its bounds too. Nodes without bounds of their own can be skipped, because their entire subtree is updated as well
+  // and any descendant with bounds propagates the change upwards. Distinct slots can be flagged from multiple threads at once.
+  if(!storage.local_bounds[slot].IsEmpty() && !storage.bounds_dirty[slot]) {
+    storage.bounds_dirty[slot] = 1u;
+    bounds_dirty_slots.push_back(slot);
+  }
+
+  // Only nodes that are visible in the world are of interest to consumers of the scene patches.
+  return node->m_is_world_visible;
+}
+
+void SceneGraph::MarkBoundsDirty(u32 slot) {
+  u8& bounds_dirty = m_transform_storage.bounds_dirty[slot];
+
+  if(!bounds_dirty) {
+    bounds_dirty = 1u;
+    m_bounds_dirty_slots.push_back(slot);
+  }
+}
+
+void SceneGraph::UpdateSubtreeBounds() {
+  if(m_bounds_dirty_slots.empty()) {
+    return;
+  }
+
+  TransformStorage& storage = m_transform_storage;
+  std::vector<u32>& dirty_slots = m_bounds_dirty_slots;
+
+  // Flag the ancestors of all dirty slots. Each slot is added to the list at most once, so this stops at the first flagged ancestor.
+  // Slots which were flagged but died since are skipped, their flags have been cleared already.
+  for(size_t i = 0u; i < dirty_slots.size(); i++) {
+    const u32 slot = dirty_slots[i];
+
+    if(storage.node[slot]) {
+      const u32 parent_slot = storage.parent[slot];
+
+      if(parent_slot != TransformStorage::k_invalid_slot) {
+        MarkBoundsDirty(parent_slot);
+      }
+    }
+  }
+
+  // Children come after their parent, so visiting the slots in reverse order ensures that the bounds of all dirty children are complete
+  // by the time they are merged into their parent. Clean children did not change and their cached bounds are merged as they are.
+  std::sort(dirty_slots.begin(), dirty_slots.end(), std::greater{});
+
+  for(const u32 slot : dirty_slots) {
+    const SceneNode* node = storage.node[slot];
+
+    if(!node) {
+      continue;
+    }
+
+    const Box3& local_bounds = storage.local_bounds[slot];
+
+    // Components may have been added to a stale node since its last transform update.
+    if(storage.stale[slot] && !local_bounds.IsEmpty()) {
+      storage.EvaluateStaleMatrices(slot);
+    }
+
+    Box3 subtree_bounds = local_bounds.IsEmpty() ? local_bounds : local_bounds.ApplyMatrix(storage.world[slot]);
+
+    for(const auto& child_node : node->GetChildren()) {
+      subtree_bounds = subtree_bounds.Union(storage.subtree_bounds[child_node->GetTransform().m_slot]);
+    }
+
+    storage.subtree_bounds[slot] = subtree_bounds;
+    storage.bounds_dirty[slot] = 0u;
+  }
+
+  dirty_slots.clear();
+}
+
+void SceneGraph::PushScenePatch(ScenePatch::Type type, SceneNode* node, ComponentTypeID component_type) {
+  NodeTableEntry& entry = m_node_table[node->m_handle.index];
+
+  // Coalesce the patch with earlier patches for the same node. Consumers read the state of a node when they process its patches,
+  // so any patch following a NodeMounted patch in the same frame is redundant, as is a repeated NodeTransformChanged patch.
+  switch(type) {
+    case ScenePatch::Type::NodeMounted: {
+      entry.mounted_this_frame = true;
+      break;
+    }
+    case ScenePatch::Type::NodeRemoved: {
+      // Earlier patches do not matter once the node is gone. If the node was mounted in this frame, there is nothing to report at all.
+      const bool mounted_this_frame = entry.mounted_this_frame;
+
+      while(entry.last_scene_patch != k_no_scene_patch) {
+        const u32 patch_index = entry.last_scene_patch;
+        const bool is_node_mounted_patch = m_scene_patches[patch_index].type == ScenePatch::Type::NodeMounted;
+
+        entry.last_scene_patch = m_previous_scene_patch_of_node[patch_index];
+        KillScenePatch(patch_index);
+
+        if(is_node_mounted_patch) {
+          break;
         }
+      }
 
-        return false;
-      });
+      entry.mounted_this_frame = false;
+      entry.transform_patched = false;
+
+      if(mounted_this_frame) {
+        return;
+      }
+      break;
+    }
+    case ScenePatch::Type::ComponentMounted: {
+      if(entry.mounted_this_frame) {
+        return;
+      }
+      break;
     }
-  } else if(m_node_world_visibility[node]) {
-    node->Traverse([this](SceneNode* child_node) {
-      if(m_node_world_visibility[child_node]) {
-        m_node_world_visibility[child_node] = false;
+    case ScenePatch::Type::ComponentRemoved: {
+      if(entry.mounted_this_frame) {
+        return;
+      }
 
-        m_scene_patches.push_back({
-          .type = ScenePatch::Type::NodeRemoved,
-          .node = child_node->GetSharedPtr()
-        });
-        return true;
+      // Removing a component that was mounted in this frame cancels out the ComponentMounted patch.
+      u32* link = &entry.last_scene_patch;
+
+      while(*link != k_no_scene_patch) {
+        const u32 patch_index = *link;
+        const ScenePatch& patch = m_scene_patches[patch_index];
+
+        if(patch.type == ScenePatch::Type::ComponentMounted && patch.component_type == component_type) {
+          *link = m_previous_scene_patch_of_node[patch_index];
+          KillScenePatch(patch_index);
+          return;
+        }
+        link = &m_previous_scene_patch_of_node[patch_index];
+      }
+      break;
+    }
+    case ScenePatch::Type::NodeTransformChanged: {
+      if(entry.mounted_this_frame || entry.transform_patched) {
+        return;
       }
+      entry.transform_patched = true;
+      break;
+    }
+  }
 
-      return false;
-    });
+  m_previous_scene_patch_of_node.push_back(entry.last_scene_patch);
+  entry.last_scene_patch = (u32)m_scene_patches.size();
+
+  m_scene_patches.push_back({
+    .type = type,
+    .node = node->m_handle,
+    .component_type = component_type
+  });
+}
+
+void SceneGraph::KillScenePatch(u32 patch_index) {
+  // Dead patches are marked by an invalid handle and are dropped in bulk by CompactScenePatches().
+  m_scene_patches[patch_index].node = {};
+  m_previous_scene_patch_of_node[patch_index] = k_no_scene_patch;
+  m_number_of_dead_scene_patches++;
+}
+
+void SceneGraph::CompactScenePatches() {
+  const size_t patch_count = m_scene_patches.size();
+  size_t new_patch_count = 0u;
+
+  // Relink the live patches of each node while moving them, since their indices change.
+  for(size_t patch_index = 0u; patch_index < patch_count; patch_index++) {
+    if(m_scene_patches[patch_index].node.IsValid()) {
+      m_node_table[m_scene_patches[patch_index].node.index].last_scene_patch = k_no_scene_patch;
+    }
+  }
+
+  for(size_t patch_index = 0u; patch_index < patch_count; patch_index++) {
+    const ScenePatch& patch = m_scene_patches[patch_index];
+    if(!patch.node.IsValid()) {
+      continue;
+    }
+
+    NodeTableEntry& entry = m_node_table[patch.node.index];
+    const u32 new_patch_index = (u32)new_patch_count++;
+
+    m_scene_patches[new_patch_index] = patch;
+    m_previous_scene_patch_of_node[new_patch_index] = entry.last_scene_patch;
+    entry.last_scene_patch = new_patch_index;
+  }
+
+  m_scene_patches.erase(m_scene_patches.begin() + new_patch_count, m_scene_patches.end());
+  m_previous_scene_patch_of_node.resize(new_patch_count);
+  m_number_of_dead_scene_patches = 0u;
+}
+
+void SceneGraph::CompactTransformStorageIfNeeded() {
+  const u32 number_of_dead_slots = m_transform_storage.number_of_dead_slots;
+
+  if(number_of_dead_slots > 0u && number_of_dead_slots >= m_transform_storage.Size() / 4u) {
+    CompactTransformStorage();
+  }
+}
+
+void SceneGraph::CompactTransformStorage() {
+  TransformStorage& storage = m_transform_storage;
+
+  const u32 slot_count = storage.Size();
+  u32 new_slot_count = 0u;
+
+  // Dead slots are mapped to the new slot of the next live slot, so that the exclusive ends of subtree slot ranges can be remapped too.
+  std::vector<u32> slot_remap_table{};
+  slot_remap_table.resize(slot_count + 1u);
+
+  // The compaction is stable, so the parent-before-child order is retained.
+  // The parent of a live node is live and has been moved before the node itself, thus its new slot is known already.
+  for(u32 slot = 0u; slot < slot_count; slot++) {
+    SceneNode* node = storage.node[slot];
+    if(!node) {
+      slot_remap_table[slot] = new_slot_count;
+      continue;
+    }
+
+    const u32 new_slot = new_slot_count++;
+    const u32 parent_slot = storage.parent[slot];
+    slot_remap_table[slot] = new_slot;
+
+    storage.node[new_slot] = node;
+    storage.parent[new_slot] = parent_slot != TransformStorage::k_invalid_slot ? slot_remap_table[parent_slot] : parent_slot;
+    storage.subtree_end[new_slot] = storage.subtree_end[slot];
+    storage.dirty[new_slot] = storage.dirty[slot];
+    storage.position[new_slot] = storage.position[slot];
+    storage.rotation[new_slot] = storage.rotation[slot];
+    storage.scale[new_slot] = storage.scale[slot];
+    storage.local[new_slot] = storage.local[slot];
+    storage.world[new_slot] = storage.world[slot];
+    storage.stale[new_slot] = storage.stale[slot];
+    storage.bounds_dirty[new_slot] = storage.bounds_dirty[slot];
+    storage.local_bounds[new_slot] = storage.local_bounds[slot];
+    storage.subtree_bounds[new_slot] = storage.subtree_bounds[slot];
+
+    node->GetTransform().m_slot = new_slot;
+  }
+
+  slot_remap_table[slot_count] = new_slot_count;
+
+  for(u32 slot = 0u; slot < new_slot_count; slot++) {
+    storage.subtree_end[slot] = slot_remap_table[storage.subtree_end[slot]];
+  }
+
+  storage.node.resize(new_slot_count);
+  storage.parent.resize(new_slot_count);
+  storage.subtree_end.resize(new_slot_count);
+  storage.dirty.resize(new_slot_count);
+  storage.position.resize(new_slot_count);
+  storage.rotation.resize(new_slot_count);
+  storage.scale.resize(new_slot_count);
+  storage.local.resize(new_slot_count);
+  storage.world.resize(new_slot_count);
+  storage.stale.resize(new_slot_count);
+  storage.bounds_dirty.resize(new_slot_count);
+  storage.local_bounds.resize(new_slot_count);
+  storage.subtree_bounds.resize(new_slot_count);
+  storage.number_of_dead_slots = 0u;
+
+  // The slots of the list of dirty bounds have moved as well.
+  m_bounds_dirty_slots.clear();
+
+  for(u32 slot = 0u; slot < new_slot_count; slot++) {
+    if(storage.bounds_dirty[slot]) {
+      m_bounds_dirty_slots.push_back(slot);
+    }
   }
 }
 
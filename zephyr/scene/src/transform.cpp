@@ -1,18 +1,31 @@
-
 #include <zephyr/scene/scene_node.hpp>
 #include <zephyr/scene/transform.hpp>
 
 namespace zephyr {
 
 void Transform3D::UpdateLocal() {
-  m_local_matrix = m_rotation.ToRotationMatrix();
-  m_local_matrix.X() *= m_scale.X();
-  m_local_matrix.Y() *= m_scale.Y();
-  m_local_matrix.Z() *= m_scale.Z();
-  m_local_matrix.W() = Vector4{m_position, 1.0f};
+  if(m_storage) {
+    m_storage->local[m_slot] = ComposeLocal(m_storage->position[m_slot], m_storage->rotation[m_slot], m_storage->scale[m_slot]);
+  } else {
+    m_local_matrix = ComposeLocal(m_position, m_rotation, m_scale);
+  }
 }
 
 void Transform3D::UpdateWorld() {
+  if(m_storage) {
+    const u32 parent_slot = m_storage->parent[m_slot];
+
+    if(parent_slot != TransformStorage::k_invalid_slot) {
+      if(m_storage->stale[parent_slot]) {
+        m_storage->EvaluateStaleMatrices(parent_slot);
+      }
+      m_storage->world[m_slot] = m_storage->world[parent_slot] * m_storage->local[m_slot];
+    } else {
+      m_storage->world[m_slot] = m_storage->local[m_slot];
+    }
+    return;
+  }
+
   SceneNode* parent = m_node->GetParent();
 
   if(parent) {
@@ -22,7 +35,46 @@ void Transform3D::UpdateWorld() {
   }
 }
 
+Matrix4 Transform3D::ComposeLocal(const Vector3& position, const Quaternion& rotation, const Vector3& scale) {
+  Matrix4 local_matrix = rotation.ToRotationMatrix();
+  local_matrix.X() *= scale.X();
+  local_matrix.Y() *= scale.Y();
+  local_matrix.Z() *= scale.Z();
+  local_matrix.W() = Vector4{position, 1.0f};
+  return local_matrix;
+}
+
+void TransformStorage::UpdateMatrices(u32 slot) {
+  local[slot] = Transform3D::ComposeLocal(position[slot], rotation[slot], scale[slot]);
+
+  const u32 parent_slot = parent[slot];
+  if(parent_slot != k_invalid_slot) {
+    world[slot] = world[parent_slot] * local[slot];
+  } else {
+    world[slot] = local[slot];
+  }
+}
+
+void TransformStorage::EvaluateStaleMatrices(u32 slot) {
+  // Collect the chain of stale ancestors up to the first node with up-to-date matrices, then evaluate it from the top down.
+  thread_local std::vector<u32> stale_chain{};
+  stale_chain.clear();
+
+  for(u32 current_slot = slot; current_slot != k_invalid_slot && stale[current_slot]; current_slot = parent[current_slot]) {
+    stale_chain.push_back(current_slot);
+  }
+
+  for(auto it = stale_chain.rbegin(); it != stale_chain.rend(); ++it) {
+    UpdateMatrices(*it);
+    stale[*it] = 0u;
+  }
+}
+
 void Transform3D::SignalNodeTransformChanged() {
+  if(m_node->IsStatic()) {
+    ZEPHYR_PANIC("Cannot change the transform of the static node '{}', unfreeze it via SceneNode::SetStatic(false) first", m_node->GetName());
+  }
+
   SceneGraph* scene_graph = m_node->m_scene_graph;
   if(scene_graph) {
     scene_graph->SignalNodeTransformChanged(m_node);